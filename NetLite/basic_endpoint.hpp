@@ -7,6 +7,7 @@
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
 # include <iosfwd>
+#include "NetLite/detail/hash.hpp"
 #include "NetLite/ip/address.hpp"
 #include "NetLite/ip/endpoint.hpp"
 
@@ -229,5 +230,19 @@ std::basic_ostream<Elem, Traits>& operator<<(
 
 } // namespace NetLite
 
+namespace std{
+
+/// Hash an endpoint from its raw socket address.
+template <typename InternetProtocol>
+struct hash<NetLite::basic_endpoint<InternetProtocol> >
+{
+    std::size_t operator()(const NetLite::basic_endpoint<InternetProtocol>& ep) const noexcept
+    {
+        return NetLite::detail::hash_sockaddr(ep.data());
+    }
+};
+
+} // namespace std
+
 
 #endif // END OF NETLITE_BASIC_ENDPOINT_HPP
@@ -10,18 +10,31 @@
 #include <functional>
 #include <algorithm>
 #include <memory>
+#include <utility>
 #include <vector>
 #include <cassert>
 #include "NetLite/net_error_code.hpp"
 #include "NetLite/socket_types.hpp"
 #include "NetLite/socket_base.hpp"
 #include "NetLite/socket_ops.hpp"
+#include "NetLite/socket_holder.hpp"
+#include "NetLite/socket_stats.hpp"
+#include "NetLite/write_coalescer.hpp"
 #include "NetLite/mutablebuf.hpp"
 #include "NetLite/detail/buffer_sequence_adapter.hpp"
 
 namespace NetLite{
 
-template<typename Protocol>
+/**
+ * Provides socket functionality.
+ *
+ * The Holder policy decides who owns the descriptor. With the default
+ * shared_socket_holder, copies of a socket share the descriptor and the last
+ * copy closes it. With unique_socket_holder the descriptor is stored inline,
+ * the socket is move-only and closes its descriptor when destroyed or
+ * assigned over.
+ */
+template<typename Protocol, typename Holder = shared_socket_holder>
 class basic_socket : public socket_base
 {
 public:
@@ -34,20 +47,21 @@ public:
     /// The endpoint type.
     typedef typename Protocol::endpoint endpoint_type;
 
-    typedef std::shared_ptr<native_handle_type> shared_socket;
+    /// The descriptor ownership policy.
+    typedef Holder holder_type;
 
 
     typedef std::function<bool()>                                   handle_method_type;
     typedef std::function<void(const std::error_code)>              async_connect_handler;
     typedef std::function<void(const std::error_code, std::size_t)> async_send_handler;
     typedef std::function<void(const std::error_code, std::size_t)> async_recv_handler;
-    typedef std::function<void(const std::error_code, typename Protocol::socket)> async_accept_handler;
+    typedef std::function<void(const std::error_code, basic_socket)> async_accept_handler;
 
 
 public:
 
     basic_socket()
-        : _shared_socket()
+        : _holder()
         , _state(0)
         , _open(false)
 
@@ -55,6 +69,9 @@ public:
     }
 
     basic_socket(const protocol_type& protocol, const native_handle_type& native_socket, std::error_code& ec)
+        : _holder()
+        , _state(0)
+        , _open(false)
     {
         assign(protocol, native_socket, ec);
     }
@@ -66,22 +83,23 @@ public:
      * @param other The other basic_socket object from which the move will
      * occur.
      */
-    basic_socket(basic_socket&& other)
+    basic_socket(basic_socket&& other) noexcept
+        : _holder()
+        , _state(0)
+        , _open(false)
     {
-        move(std::forward<basic_socket<Protocol> >(other));
+        move(std::move(other));
     }
 
     /**
      * Copy-construct a basic_socket from another.
-     * This constructor copy a socket from one object to another.
+     * This constructor copy a socket from one object to another. It is
+     * deleted when the holder is move-only.
      *
      * @param other The other basic_socket object from which the copy will
      * occur.
      */
-    basic_socket(const basic_socket& other)
-    {
-        copy(other);
-    }
+    basic_socket(const basic_socket& other) = default;
 
     /**
      * Move-assign a basic_socket from another.
@@ -90,32 +108,29 @@ public:
      * @param other The other basic_socket object from which the move will
      * occur.
      */
-    basic_socket& operator=(basic_socket&& other)
+    basic_socket& operator=(basic_socket&& other) noexcept
     {
-        move(std::forward<basic_socket<Protocol> >(other));
+        move(std::move(other));
         return *this;
     }
 
 
     /**
      * Copy-assign a basic_socket from another.
-     * This assignment operator copy a socket from one object to another.
+     * This assignment operator copy a socket from one object to another. It
+     * is deleted when the holder is move-only.
      *
      * @param other The other basic_socket object from which the copy will
      * occur.
      */
-    basic_socket& operator=(const basic_socket& other)
-    {
-        copy(other);
-        return *this;
-    }
+    basic_socket& operator=(const basic_socket& other) = default;
 
     /**
      * Virtual destructor
      */
     virtual ~basic_socket()
     {
-        if (_shared_socket && _shared_socket.use_count() == 1)
+        if (_holder.is_last_owner())
         {
             std::error_code ec;
             shutdown(shutdown_type::shutdown_both, ec);
@@ -312,9 +327,81 @@ public:
             throw_if(ec, "connect");
         }
         socket_ops::sync_connect(native_handle(), peer_endpoint.data(), peer_endpoint.size(), ec);
+        record_syscall(stats_send);
         return ec;
     }
 
+    /**
+     * Connect the socket and send the first data.
+     * Where the platform supports TCP Fast Open the connect and the send are
+     * one system call, and once the kernel holds a Fast Open cookie for the
+     * peer the data travels in the SYN, saving a round trip. The first
+     * connection to a peer, or one the peer does not accept Fast Open for,
+     * falls back to sending after the handshake. The server must enable
+     * tcp::fast_open on its listening socket.
+     *
+     * The socket is automatically opened if it is not already open.
+     *
+     * @param peer_endpoint The remote endpoint to which the socket will be
+     * connected.
+     *
+     * @param buffers One or more data buffers to be sent on the socket.
+     *
+     * @returns The number of bytes sent.
+     *
+     * @throws std::system_error Thrown on failure.
+     *
+     * @par Example
+     * @code
+     * NetLite::tcp::socket socket;
+     * socket.connect_and_send(cache_endpoint, NetLite::constbuf(request.data(), request.size()));
+     * @endcode
+     */
+    template <typename ConstBufferSequence>
+    std::size_t connect_and_send(const endpoint_type& peer_endpoint, const ConstBufferSequence& buffers)
+    {
+        std::error_code ec;
+        std::size_t len = this->connect_and_send(peer_endpoint, buffers, ec);
+        throw_if(ec, "connect_and_send");
+        return len;
+    }
+
+    std::size_t connect_and_send(const endpoint_type& peer_endpoint, const constbuf& buffers)
+    {
+        std::error_code ec;
+        std::size_t len = this->connect_and_send(peer_endpoint, buffers, ec);
+        throw_if(ec, "connect_and_send");
+        return len;
+    }
+
+    /**
+     * Connect the socket and send the first data.
+     *
+     * @param peer_endpoint The remote endpoint to which the socket will be
+     * connected.
+     *
+     * @param buffers One or more data buffers to be sent on the socket.
+     *
+     * @param ec Set to indicate what error occurred, if any.
+     *
+     * @returns The number of bytes sent. Returns 0 if an error occurred.
+     */
+    template <typename ConstBufferSequence>
+    std::size_t connect_and_send(const endpoint_type& peer_endpoint, const ConstBufferSequence& buffers,
+        std::error_code& ec)
+    {
+        buffer_sequence_adapter<constbuf, ConstBufferSequence> bufs(buffers);
+        return connect_and_send(peer_endpoint, bufs.buffers(), bufs.count(), bufs.total_size(), ec);
+    }
+
+    std::size_t connect_and_send(const endpoint_type& peer_endpoint, const constbuf& buffers,
+        std::error_code& ec)
+    {
+        socket_ops::buf sendBuf;
+        socket_ops::init_buf(sendBuf, buffers.data(), buffers.size());
+        return connect_and_send(peer_endpoint, &sendBuf, 1, buffers.size(), ec);
+    }
+
     /**
      * Bind the socket to the given local endpoint.
      * This function binds the socket to the specified endpoint on the local
@@ -439,7 +526,16 @@ public:
         if ((_state & socket_ops::stream_oriented))
         {
             buffer_sequence_adapter<constbuf,ConstBufferSequence> bufs(buffers);
-            return socket_ops::send(native_handle(), bufs.buffers(), bufs.count(), flags, ec);
+            if (_coalescer)
+            {
+                if (flags == 0)
+                    return _coalescer->write(bufs.buffers(), bufs.count(), bufs.total_size(), ec);
+                // Staged data goes out first to keep the byte order.
+                if (_coalescer->flush(ec))
+                    return 0;
+            }
+            signed_size_type result = socket_ops::send(native_handle(), bufs.buffers(), bufs.count(), flags, ec);
+            return record_send(bufs.total_size(), result, ec);
         }
         else
         {
@@ -455,7 +551,15 @@ public:
         {
             socket_ops::buf sendBuf;
             socket_ops::init_buf(sendBuf, buffers.data(), buffers.size());
-            return socket_ops::send(native_handle(), &sendBuf, 1, flags, ec);
+            if (_coalescer)
+            {
+                if (flags == 0)
+                    return _coalescer->write(&sendBuf, 1, buffers.size(), ec);
+                if (_coalescer->flush(ec))
+                    return 0;
+            }
+            signed_size_type result = socket_ops::send(native_handle(), &sendBuf, 1, flags, ec);
+            return record_send(buffers.size(), result, ec);
         }
         else
         {
@@ -537,7 +641,8 @@ public:
         if ((_state & socket_ops::stream_oriented))
         {
             buffer_sequence_adapter<mutablebuf, MutableBufferSequence> bufs(buffers);
-            return socket_ops::recv(native_handle(), bufs.buffers(), bufs.count(), flags, ec);
+            signed_size_type result = socket_ops::recv(native_handle(), bufs.buffers(), bufs.count(), flags, ec);
+            return record_receive(bufs.total_size(), result, ec);
         }
         else
         {
@@ -553,7 +658,8 @@ public:
         {
             socket_ops::buf recvBuf;
             socket_ops::init_buf(recvBuf, buffers.data(), buffers.size());
-            return socket_ops::recv(native_handle(), &recvBuf, 1, flags, ec);
+            signed_size_type result = socket_ops::recv(native_handle(), &recvBuf, 1, flags, ec);
+            return record_receive(buffers.size(), result, ec);
         }
         else
         {
@@ -615,13 +721,14 @@ public:
         {
             socket_ops::buf sendToBuf;
             socket_ops::init_buf(sendToBuf, buffers.data(), buffers.size());
-            return socket_ops::sendto(native_handle()
+            signed_size_type result = socket_ops::sendto(native_handle()
                 , &sendToBuf
                 , 1
                 , flags
                 , destination.data()
                 , destination.size()
                 , ec);
+            return record_send(buffers.size(), result, ec);
         }
         else
         {
@@ -692,6 +799,7 @@ public:
         if (!ec)
             sender_endpoint.resize(addr_len);
 
+        record_receive(buffers.size(), static_cast<signed_size_type>(bytes_recvd), ec);
         return bytes_recvd;
     }
 
@@ -747,7 +855,8 @@ public:
      * @param peer_endpoint An endpoint object into which the endpoint of the
      * remote peer will be written.
      *
-     * @returns A socket object representing the newly accepted connection.
+     * @returns A socket object representing the newly accepted connection,
+     * with the same descriptor ownership policy as this socket.
      *
      * @throws std::system_error Thrown on failure.
      *
@@ -758,10 +867,10 @@ public:
      * ip::tcp::socket socket.accept(endpoint);
      * @endcode
      */
-    typename Protocol::socket accept(endpoint_type& peer_endpoint)
+    basic_socket accept(endpoint_type& peer_endpoint)
     {
         std::error_code ec;
-        typename Protocol::socket new_socket = this->accept(peer_endpoint, ec);
+        basic_socket new_socket = this->accept(peer_endpoint, ec);
         throw_if(ec, "accept");
         return new_socket;
     }
@@ -794,7 +903,7 @@ public:
      * }
      * @endcode
      */
-    typename Protocol::socket accept(endpoint_type& peer_endpoint, std::error_code& ec)
+    basic_socket accept(endpoint_type& peer_endpoint, std::error_code& ec)
     {
         size_t addrLen = peer_endpoint.size();
         native_handle_type native_socket = socket_ops::sync_accept(native_handle()
@@ -802,14 +911,118 @@ public:
             , peer_endpoint.data()
             , &addrLen
             , ec);
+        record_syscall(stats_receive);
+        basic_socket new_socket;
         if (native_socket != invalid_socket)
         {
             peer_endpoint.resize(addrLen);
+            new_socket.assign(this->_protocol, native_socket, ec);
         }
-        typename Protocol::socket new_socket(this->_protocol, native_socket, ec);
         return new_socket;
     }
 
+    /**
+     * Accept all pending connections, up to a limit.
+     * This function drains the listen backlog without blocking, typically once
+     * per readiness notification. The listening socket is put into internal
+     * non-blocking mode, and every accepted socket is created non-blocking and
+     * close-on-exec (with a single accept4 call on Linux), so it can be handed
+     * to a reactor without further system calls.
+     *
+     * @param sockets The vector to which the accepted sockets and the
+     * endpoints of their peers are appended.
+     *
+     * @param max_count The largest number of connections to accept.
+     *
+     * @returns The number of connections accepted. Zero means the backlog was
+     * empty.
+     *
+     * @throws std::system_error Thrown on failure. Sockets accepted before the
+     * failure are still appended.
+     *
+     * @par Example
+     * @code
+     * std::vector<std::pair<NetLite::tcp::socket, NetLite::tcp::endpoint> > accepted;
+     * acceptor.accept_batch(accepted, 64);
+     * for (auto& peer : accepted)
+     *     register_connection(std::move(peer.first), peer.second);
+     * @endcode
+     */
+    std::size_t accept_batch(std::vector<std::pair<basic_socket, endpoint_type> >& sockets,
+        std::size_t max_count)
+    {
+        std::error_code ec;
+        std::size_t count = this->accept_batch(sockets, max_count, ec);
+        throw_if(ec, "accept_batch");
+        return count;
+    }
+
+    /**
+     * Accept all pending connections, up to a limit.
+     * This function drains the listen backlog without blocking, typically once
+     * per readiness notification. The listening socket is put into internal
+     * non-blocking mode, and every accepted socket is created non-blocking and
+     * close-on-exec (with a single accept4 call on Linux), so it can be handed
+     * to a reactor without further system calls.
+     *
+     * @param sockets The vector to which the accepted sockets and the
+     * endpoints of their peers are appended.
+     *
+     * @param max_count The largest number of connections to accept.
+     *
+     * @param ec Set to indicate what error occurred, if any. An empty backlog
+     * is not an error.
+     *
+     * @returns The number of connections accepted.
+     */
+    std::size_t accept_batch(std::vector<std::pair<basic_socket, endpoint_type> >& sockets,
+        std::size_t max_count, std::error_code& ec)
+    {
+        ec = std::error_code();
+        if ((_state & socket_ops::non_blocking) == 0
+            && !socket_ops::set_internal_non_blocking(native_handle(), _state, true, ec))
+            return 0;
+
+        std::size_t count = 0;
+        while (count < max_count)
+        {
+            endpoint_type peer_endpoint;
+            std::size_t addr_len = peer_endpoint.capacity();
+            native_handle_type native_socket = socket_ops::accept(native_handle()
+                , peer_endpoint.data()
+                , &addr_len
+                , socket_ops::accept_non_blocking | socket_ops::accept_close_on_exec
+                , ec);
+            record_syscall(stats_receive);
+            if (native_socket == invalid_socket)
+            {
+                if (ec == std::errc::operation_would_block
+                    || ec == std::errc::resource_unavailable_try_again)
+                {
+                    ec = std::error_code();
+                    break;
+                }
+                // The peer went away before it could be accepted, or a signal
+                // arrived; carry on with the rest of the backlog.
+                if (ec == std::errc::interrupted
+                    || ec == std::errc::connection_aborted
+#if defined(EPROTO)
+                    || ec.value() == EPROTO
+#endif // defined(EPROTO)
+                    )
+                    continue;
+                break;
+            }
+
+            peer_endpoint.resize(addr_len);
+            basic_socket new_socket(this->_protocol, native_socket, ec);
+            new_socket._state |= socket_ops::user_set_non_blocking | socket_ops::internal_non_blocking;
+            sockets.push_back(std::make_pair(std::move(new_socket), peer_endpoint));
+            ++count;
+        }
+        return count;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     /// asynchronous operation functions
 
@@ -864,7 +1077,15 @@ public:
      */
     std::error_code non_blocking( bool mode, std::error_code& ec)
     {
+        // Coalesced sends are flushed from the loop, which must not block.
+        if (_coalescer && !mode)
+        {
+            ec = make_error_code(std::errc::invalid_argument);
+            return ec;
+        }
         socket_ops::set_user_non_blocking(native_handle(), _state, mode, ec);
+        if (_coalescer)
+            _coalescer->set_state(_state);
         return ec;
     }
 
@@ -1267,7 +1488,7 @@ public:
      * signature of the handler must be:
      * @code void handler(
      *   const std::error_code& error, // Result of operation.
-     *   typename Protocol::socket peer // On success, the newly accepted socket.
+     *   basic_socket peer // On success, the newly accepted socket.
      * ); @endcode
      *
      * @par Example
@@ -1426,10 +1647,10 @@ public:
             switch (w)
             {
             case socket_base::wait_read:
-                SelectStatus = socket_ops::poll_read(native_handle(), _state, 16,ec);
+                SelectStatus = poll_read(16, ec);
                 break;
             case socket_base::wait_write:
-                SelectStatus = socket_ops::poll_write(native_handle(), _state, 16, ec);
+                SelectStatus = poll_write(16, ec);
                 break;
             case socket_base::wait_error:
                 SelectStatus = socket_ops::poll_error(native_handle(), _state, 16, ec);
@@ -1494,6 +1715,12 @@ public:
      */
     std::error_code shutdown(shutdown_type what, std::error_code& ec)
     {
+        // Coalesced data must leave before the FIN.
+        if (_coalescer && what != shutdown_receive)
+        {
+            std::error_code ignored_ec;
+            _coalescer->flush(ignored_ec);
+        }
         socket_ops::shutdown(native_handle(), what, ec);
         return ec ;
     }
@@ -1543,6 +1770,12 @@ public:
      */
     std::error_code close(std::error_code& ec)
     {
+        if (_coalescer)
+        {
+            std::error_code ignored_ec;
+            _coalescer->flush(ignored_ec);
+            _coalescer.reset();
+        }
         socket_ops::close(native_handle(), _state, false, ec);
         reset();
         return ec;
@@ -1595,7 +1828,7 @@ public:
     endpoint_type local_endpoint(std::error_code& ec) const
     {
         endpoint_type endpoint;
-        int addr_len = static_cast<int>(endpoint.capacity());
+        std::size_t addr_len = endpoint.capacity();
         if (socket_ops::getsockname(native_handle(), endpoint.data(), &addr_len, ec))
             return endpoint_type();
         endpoint.resize(addr_len);
@@ -1660,16 +1893,12 @@ public:
 
     native_handle_type native_handle()const
     {
-        if (!_shared_socket)
-        {
-            return invalid_socket;
-        }
-        return *_shared_socket;
+        return _holder.get();
     }
 
     explicit operator bool() const
     {
-        return (_shared_socket && *_shared_socket != invalid_socket);
+        return _holder.get() != invalid_socket;
     }
 
     /**
@@ -1819,11 +2048,11 @@ public:
         switch (state)
         {
         case socket_state::readable:
-            SelectStatus = socket_ops::poll_read(native_handle(), _state, 10, ec);
+            SelectStatus = poll_read(10, ec);
             break;
 
         case socket_state::writable:
-            SelectStatus = socket_ops::poll_write(native_handle(), _state, 10, ec);
+            SelectStatus = poll_write(10, ec);
             break;
 
         case socket_state::haserror:
@@ -1837,38 +2066,309 @@ public:
         // and negative is API error condition (not socket's error state)
         return SelectStatus > 0 ? state_return::Yes : (SelectStatus == 0 ? state_return::No : state_return::EncounteredError);
     }
+
+#if defined(NETWORK_ENABLE_SOCKET_STATS)
+    /**
+     * Get the I/O counters of the socket.
+     * The counters start when the socket is opened or assigned and are shared
+     * by all copies of the socket. Only available when
+     * NETWORK_ENABLE_SOCKET_STATS is defined.
+     *
+     * @returns A snapshot of the counters, all zero if the socket was never
+     * opened.
+     *
+     * @par Example
+     * Finding a connection that writes in tiny pieces:
+     * @code
+     * NetLite::socket_stats::snapshot s = socket.stats();
+     * if (s.send_ops > 1000 && s.mean_send_size() < 16)
+     *     log_chatty_peer(socket.remote_endpoint());
+     * @endcode
+     */
+    socket_stats::snapshot stats() const
+    {
+        return _stats ? _stats->load() : socket_stats::snapshot();
+    }
+
+    /// Set the I/O counters of the socket to zero.
+    void reset_stats()
+    {
+        if (_stats)
+            _stats->reset();
+    }
+#endif // defined(NETWORK_ENABLE_SOCKET_STATS)
+
+    /**
+     * Coalesce the sends made on the socket during each loop iteration.
+     * From now on send() without flags copies the data into a staging buffer
+     * and returns at once; the scheduler sends everything staged with one
+     * system call at the end of the iteration. Data beyond 64 KiB per
+     * iteration is sent early, together with the staged data.
+     *
+     * The socket is put in non-blocking mode, so that the flush never holds
+     * up the loop, and stays in it while coalescing is enabled. When the
+     * socket is full, send() takes only what it could send, or fails with
+     * std::errc::operation_would_block; wait until it is writable and call
+     * flush() before sending more.
+     *
+     * @param scheduler The io_context whose loop flushes the socket. It must
+     * outlive the socket, and sends must be made from the thread running its
+     * loop.
+     *
+     * @param cork Set TCP_CORK while data is sent early, so that it does not
+     * leave in partial segments.
+     *
+     * @throws std::system_error Thrown on failure.
+     *
+     * @par Example
+     * Fanning an event out to many subscribers:
+     * @code
+     * subscriber.enable_write_coalescing(io);
+     * ...
+     * // In a handler: each of these only copies into the staging buffer.
+     * subscriber.send(NetLite::constbuf(header, header_size));
+     * subscriber.send(NetLite::constbuf(payload, payload_size));
+     * @endcode
+     *
+     * @note A send that fails after send() has returned is reported by the
+     * next send() or flush(). The end of iteration flush stops when the
+     * socket would block; call flush() again once the socket is writable.
+     */
+    void enable_write_coalescing(flush_scheduler& scheduler, bool cork = false)
+    {
+        std::error_code ec;
+        this->enable_write_coalescing(scheduler, cork, ec);
+        throw_if(ec, "enable_write_coalescing");
+    }
+
+    /**
+     * Coalesce the sends made on the socket during each loop iteration.
+     *
+     * @param scheduler The io_context whose loop flushes the socket.
+     *
+     * @param cork Set TCP_CORK while data is sent early.
+     *
+     * @param ec Set to indicate what error occurred, if any. Sockets that are
+     * not stream oriented fail with std::errc::operation_not_supported.
+     */
+    std::error_code enable_write_coalescing(flush_scheduler& scheduler, bool cork, std::error_code& ec)
+    {
+        if (!this->is_open())
+        {
+            ec = make_error_code(std::errc::bad_file_descriptor);
+            return ec;
+        }
+        if ((_state & socket_ops::stream_oriented) == 0)
+        {
+            ec = make_error_code(std::errc::operation_not_supported);
+            return ec;
+        }
+        if (_coalescer && _coalescer->flush(ec))
+            return ec;
+        if (!socket_ops::set_user_non_blocking(native_handle(), _state, true, ec))
+            return ec;
+        std::shared_ptr<socket_stats> stats;
+#if defined(NETWORK_ENABLE_SOCKET_STATS)
+        stats = _stats;
+#endif // defined(NETWORK_ENABLE_SOCKET_STATS)
+        _coalescer = std::make_shared<write_coalescer>(scheduler, native_handle(), _state, cork,
+            std::size_t(write_coalescer::default_limit), stats);
+        ec = std::error_code();
+        return ec;
+    }
+
+    /**
+     * Send what is staged and return to sending immediately.
+     * @throws std::system_error Thrown on failure.
+     */
+    void disable_write_coalescing()
+    {
+        std::error_code ec;
+        this->disable_write_coalescing(ec);
+        throw_if(ec, "disable_write_coalescing");
+    }
+
+    /// Send what is staged and return to sending immediately. The socket
+    /// stops coalescing even if the final send fails.
+    std::error_code disable_write_coalescing(std::error_code& ec)
+    {
+        ec = std::error_code();
+        if (_coalescer)
+        {
+            _coalescer->flush(ec);
+            _coalescer.reset();
+        }
+        return ec;
+    }
+
+    /// Determine whether sends on the socket are coalesced.
+    bool write_coalescing() const
+    {
+        return _coalescer != nullptr;
+    }
+
+    /**
+     * Send the data staged by write coalescing now, without waiting for the
+     * end of the loop iteration.
+     * @throws std::system_error Thrown on failure.
+     */
+    void flush()
+    {
+        std::error_code ec;
+        this->flush(ec);
+        throw_if(ec, "flush");
+    }
+
+    /**
+     * Send the data staged by write coalescing now.
+     *
+     * @param ec Set to indicate what error occurred, if any, including a
+     * failure of an earlier coalesced send. std::errc::operation_would_block
+     * means part of the data is still staged.
+     */
+    std::error_code flush(std::error_code& ec)
+    {
+        ec = std::error_code();
+        if (_coalescer)
+            _coalescer->flush(ec);
+        return ec;
+    }
+
 protected:
     void holdsSocket(native_handle_type native_socket)
     {
-        _shared_socket = shared_socket(new native_handle_type(native_socket));
+        _holder.hold(native_socket);
+#if defined(NETWORK_ENABLE_SOCKET_STATS)
+        _stats = std::make_shared<socket_stats>();
+#endif // defined(NETWORK_ENABLE_SOCKET_STATS)
     }
 
     void reset()
     {
-        _shared_socket.reset();
+        _holder.reset();
         _open = false;
     }
 
-    void move(basic_socket&& other)
+    void move(basic_socket&& other) noexcept
     {
-        this->_shared_socket = std::move(other._shared_socket);
+        if (this == &other)
+            return;
+        // Staged data goes out on the old descriptor before it is closed.
+        _coalescer.reset();
+        // A descriptor owned only by this socket would otherwise leak.
+        if (_holder.is_last_owner())
+        {
+            std::error_code ec;
+            socket_ops::close(native_handle(), _state, false, ec);
+        }
+        this->_holder = std::move(other._holder);
         this->_open = other._open;
         this->_state = other._state;
         this->_protocol = other._protocol;
+#if defined(NETWORK_ENABLE_SOCKET_STATS)
+        this->_stats = std::move(other._stats);
+#endif // defined(NETWORK_ENABLE_SOCKET_STATS)
+        this->_coalescer = std::move(other._coalescer);
+        other._holder.reset();
         other._open = false;
     }
 
-    void copy(const basic_socket& other)
+    std::size_t connect_and_send(const endpoint_type& peer_endpoint, const socket_ops::buf* bufs,
+        std::size_t count, std::size_t total_size, std::error_code& ec)
     {
-        this->_shared_socket =other._shared_socket;
-        this->_open = other._open;
-        this->_state = other._state;
-        this->_protocol = other._protocol;
+        if (!this->is_open())
+        {
+            this->open(peer_endpoint.protocol(), ec);
+            if (ec)
+                return 0;
+        }
+        signed_size_type result = socket_ops::sync_connect_and_send(native_handle(), bufs, count,
+            peer_endpoint.data(), peer_endpoint.size(), ec);
+        return record_send(total_size, result, ec);
     }
+
+    enum stats_side { stats_send, stats_receive };
+
+    // Count a send and turn the system call's result into a byte count,
+    // which is 0 on failure. The counting compiles away unless
+    // NETWORK_ENABLE_SOCKET_STATS is defined.
+    std::size_t record_send(std::size_t requested, signed_size_type result, const std::error_code& ec)
+    {
+        std::size_t transferred = result < 0 ? 0 : static_cast<std::size_t>(result);
+#if defined(NETWORK_ENABLE_SOCKET_STATS)
+        if (_stats)
+            _stats->record_send(requested, transferred, ec);
+#else // defined(NETWORK_ENABLE_SOCKET_STATS)
+        (void)requested;
+        (void)ec;
+#endif // defined(NETWORK_ENABLE_SOCKET_STATS)
+        return transferred;
+    }
+
+    // Count a receive, as record_send() does.
+    std::size_t record_receive(std::size_t requested, signed_size_type result, const std::error_code& ec)
+    {
+        std::size_t transferred = result < 0 ? 0 : static_cast<std::size_t>(result);
+#if defined(NETWORK_ENABLE_SOCKET_STATS)
+        if (_stats)
+            _stats->record_receive(requested, transferred, ec);
+#else // defined(NETWORK_ENABLE_SOCKET_STATS)
+        (void)requested;
+        (void)ec;
+#endif // defined(NETWORK_ENABLE_SOCKET_STATS)
+        return transferred;
+    }
+
+    // Count a system call that moves no data.
+    void record_syscall(stats_side side)
+    {
+#if defined(NETWORK_ENABLE_SOCKET_STATS)
+        if (_stats)
+        {
+            if (side == stats_send)
+                _stats->record_send_syscall();
+            else
+                _stats->record_receive_syscall();
+        }
+#else // defined(NETWORK_ENABLE_SOCKET_STATS)
+        (void)side;
+#endif // defined(NETWORK_ENABLE_SOCKET_STATS)
+    }
+
+    // Wait until readable, timing the wait for the counters.
+    int poll_read(int msec, std::error_code& ec)
+    {
+#if defined(NETWORK_ENABLE_SOCKET_STATS)
+        uint64_t start = _stats ? socket_stats::now_ns() : 0;
+        int result = socket_ops::poll_read(native_handle(), _state, msec, ec);
+        if (_stats)
+            _stats->record_poll_read(socket_stats::now_ns() - start);
+        return result;
+#else // defined(NETWORK_ENABLE_SOCKET_STATS)
+        return socket_ops::poll_read(native_handle(), _state, msec, ec);
+#endif // defined(NETWORK_ENABLE_SOCKET_STATS)
+    }
+
+    // Wait until writable, timing the wait for the counters.
+    int poll_write(int msec, std::error_code& ec)
+    {
+#if defined(NETWORK_ENABLE_SOCKET_STATS)
+        uint64_t start = _stats ? socket_stats::now_ns() : 0;
+        int result = socket_ops::poll_write(native_handle(), _state, msec, ec);
+        if (_stats)
+            _stats->record_poll_write(socket_stats::now_ns() - start);
+        return result;
+#else // defined(NETWORK_ENABLE_SOCKET_STATS)
+        return socket_ops::poll_write(native_handle(), _state, msec, ec);
+#endif // defined(NETWORK_ENABLE_SOCKET_STATS)
+    }
+
 private:
+    // Marks the connections its multishot accept creates as non-blocking.
+    friend class io_uring_io_context;
 
     /// Holds the BSD socket object. */
-    shared_socket           _shared_socket;
+    Holder                  _holder;
 
     /// The socket state type
     socket_ops::state_type  _state;
@@ -1878,6 +2378,15 @@ private:
 
     /// The socket is open ?
     bool                    _open;
+
+#if defined(NETWORK_ENABLE_SOCKET_STATS)
+    /// The I/O counters, shared by copies of the socket.
+    std::shared_ptr<socket_stats> _stats;
+#endif // defined(NETWORK_ENABLE_SOCKET_STATS)
+
+    /// Stages sends until the end of the loop iteration, if enabled. Declared
+    /// last so that it flushes before the descriptor goes away.
+    std::shared_ptr<write_coalescer> _coalescer;
 };
 
 } // namespace NetLite
@@ -0,0 +1,274 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_BUFFER_POOL_HPP
+#define NETLITE_BUFFER_POOL_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+#include "NetLite/config.hpp"
+#include "NetLite/mutablebuf.hpp"
+
+namespace NetLite{
+
+/**
+ * A slab pool of I/O buffers in three size classes: 2K, 16K and 64K.
+ *
+ * acquire() hands out a block as a mutablebuf. The block goes back to the
+ * pool when the last copy of that mutablebuf is destroyed, so a receive path
+ * that only borrows a block while data is being handled needs memory in
+ * proportion to the active connections, not the open ones.
+ *
+ * Blocks are carved from large arenas and never go back to the general
+ * purpose allocator while the pool exists. Each thread keeps a small
+ * magazine of free blocks per size class, and only takes the pool's lock to
+ * exchange half a magazine with the shared depot. The shared pointer that a
+ * mutablebuf needs is built inside a header in front of the block, so
+ * acquiring and releasing a block allocates nothing in steady state.
+ *
+ * The pool must outlive every buffer it hands out.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Safe.
+ */
+class buffer_pool
+{
+public:
+    /// The size classes.
+    enum
+    {
+        small_block_size = 2048,
+        medium_block_size = 16384,
+        large_block_size = 65536
+    };
+
+    /**
+     * Construct a pool.
+     *
+     * @param block_size The size of the blocks handed out by acquire()
+     * without arguments, rounded up to a size class.
+     *
+     * @param huge_pages Back the arenas with huge pages where the system
+     * provides them. On Linux this tries MAP_HUGETLB and falls back to
+     * transparent huge pages; elsewhere it is ignored.
+     *
+     * @throws std::length_error Thrown if block_size is larger than the
+     * largest size class.
+     */
+    NETWORK_API explicit buffer_pool(std::size_t block_size = medium_block_size,
+        bool huge_pages = false);
+
+    /// Destroy the pool and free its arenas.
+    NETWORK_API ~buffer_pool();
+
+    buffer_pool(const buffer_pool&) = delete;
+    buffer_pool& operator=(const buffer_pool&) = delete;
+
+    /**
+     * Borrow a block of block_size() bytes.
+     * @throws std::bad_alloc Thrown if a new arena cannot be allocated.
+     */
+    mutablebuf acquire()
+    {
+        return acquire_class(default_class_);
+    }
+
+    /**
+     * Borrow a block of at least the given size.
+     * The block comes from the smallest size class that fits. Larger
+     * requests are served by the general purpose allocator.
+     *
+     * @returns A buffer whose size() is the size of the block, which may be
+     * larger than requested.
+     *
+     * @throws std::bad_alloc Thrown if memory cannot be allocated.
+     */
+    NETWORK_API mutablebuf acquire(std::size_t size);
+
+    /// Get the size of the blocks handed out by acquire() without arguments.
+    std::size_t block_size() const
+    {
+        return class_size(default_class_);
+    }
+
+    /// Get the number of bytes held in arenas.
+    NETWORK_API std::size_t reserved_bytes() const;
+
+    /// Get the number of free blocks in the shared depot, not counting those
+    /// cached by threads.
+    NETWORK_API std::size_t free_blocks() const;
+
+    /// Move the free blocks cached by the calling thread to the shared depot.
+    NETWORK_API void flush_thread_cache();
+
+private:
+    enum
+    {
+        class_count = 3,
+
+        // Room in front of every block for the shared pointer's control
+        // block.
+        header_size = 64,
+
+        // Free blocks a thread may cache per size class.
+        magazine_size = 32,
+
+        // Size of an arena, one huge page on x86-64.
+        arena_size = 2 * 1024 * 1024
+    };
+
+    static std::size_t class_size(unsigned size_class)
+    {
+        static const std::size_t sizes[class_count] =
+            { small_block_size, medium_block_size, large_block_size };
+        return sizes[size_class];
+    }
+
+    struct size_class_state
+    {
+        // Free blocks shared by all threads.
+        std::vector<char*> depot;
+
+        // The unused part of the newest arena.
+        char* next;
+        char* end;
+    };
+
+    struct arena
+    {
+        void* memory;
+        std::size_t bytes;
+        bool mapped;
+    };
+
+    // The shared part of the pool. Thread caches hold it weakly so they can
+    // tell whether the pool is still alive when the thread exits.
+    struct state
+    {
+        uint64_t id;
+        std::weak_ptr<state> self;
+        bool huge_pages;
+        mutable std::mutex mutex;
+        size_class_state classes[class_count];
+        std::vector<arena> arenas;
+
+        NETWORK_API ~state();
+    };
+
+    // The free blocks one thread caches for one pool.
+    struct thread_magazines
+    {
+        uint64_t pool_id;
+        std::weak_ptr<state> owner;
+        std::size_t count[class_count];
+        char* blocks[class_count][magazine_size];
+    };
+
+    struct thread_cache
+    {
+        enum { max_pools = 4 };
+        thread_magazines pools[max_pools];
+
+        thread_cache()
+        {
+            for (std::size_t i = 0; i < max_pools; ++i)
+                pools[i].pool_id = 0;
+        }
+
+        NETWORK_API ~thread_cache();
+    };
+
+    // Lends out the header of a block for the shared pointer's control block
+    // and returns the block to its pool once the control block is gone.
+    template <typename T>
+    class header_allocator
+    {
+    public:
+        typedef T value_type;
+
+        header_allocator(state* s, unsigned size_class, char* block) noexcept
+            : state_(s)
+            , size_class_(size_class)
+            , block_(block)
+        {
+        }
+
+        template <typename U>
+        header_allocator(const header_allocator<U>& other) noexcept
+            : state_(other.state_)
+            , size_class_(other.size_class_)
+            , block_(other.block_)
+        {
+        }
+
+        T* allocate(std::size_t n)
+        {
+            if (n * sizeof(T) <= header_size)
+                return reinterpret_cast<T*>(block_);
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, std::size_t)
+        {
+            if (reinterpret_cast<char*>(p) != block_)
+                ::operator delete(p);
+            buffer_pool::release(state_, size_class_, block_);
+        }
+
+        friend bool operator==(const header_allocator& a, const header_allocator& b) noexcept
+        {
+            return a.block_ == b.block_;
+        }
+
+        friend bool operator!=(const header_allocator& a, const header_allocator& b) noexcept
+        {
+            return a.block_ != b.block_;
+        }
+
+    private:
+        template <typename U> friend class header_allocator;
+
+        state* state_;
+        unsigned size_class_;
+        char* block_;
+    };
+
+    // The block is released by the allocator, after the control block that
+    // lives in its header has been destroyed.
+    struct no_delete
+    {
+        void operator()(uint8_t*) const noexcept
+        {
+        }
+    };
+
+    NETWORK_API mutablebuf acquire_class(unsigned size_class);
+    NETWORK_API static void release(state* s, unsigned size_class, char* block);
+    NETWORK_API static thread_cache& local_cache();
+    NETWORK_API static bool& local_cache_destroyed();
+    NETWORK_API static thread_magazines* find_magazines(state& s);
+    NETWORK_API static void flush(state& s, thread_magazines& m, unsigned size_class, std::size_t keep);
+    NETWORK_API static void refill(state& s, thread_magazines& m, unsigned size_class);
+
+    unsigned default_class_;
+    std::shared_ptr<state> state_;
+};
+
+} // namespace NetLite
+
+#include "NetLite/buffer_pool.ipp"
+
+#endif // END OF NETLITE_BUFFER_POOL_HPP
@@ -0,0 +1,289 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_BUFFER_POOL_IPP
+#define NETLITE_BUFFER_POOL_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <atomic>
+#include <stdexcept>
+#if defined(__linux__)
+# include <sys/mman.h>
+#endif // defined(__linux__)
+#include "NetLite/buffer_pool.hpp"
+
+namespace NetLite{
+
+buffer_pool::buffer_pool(std::size_t block_size, bool huge_pages)
+    : default_class_(0)
+    , state_(std::make_shared<state>())
+{
+    while (class_size(default_class_) < block_size)
+    {
+        if (++default_class_ == class_count)
+            throw std::length_error("buffer_pool block size too large");
+    }
+
+    // Pool IDs are never reused, so a thread cache left behind by a
+    // destroyed pool cannot be mistaken for one of a new pool.
+    static std::atomic<uint64_t> next_id(1);
+    state_->id = next_id.fetch_add(1, std::memory_order_relaxed);
+    state_->self = state_;
+    state_->huge_pages = huge_pages;
+    for (unsigned i = 0; i < class_count; ++i)
+    {
+        state_->classes[i].next = 0;
+        state_->classes[i].end = 0;
+    }
+}
+
+buffer_pool::~buffer_pool()
+{
+    // Drop the calling thread's cache now; other threads drop theirs when
+    // they see the pool is gone.
+    thread_magazines* m = find_magazines(*state_);
+    if (m)
+    {
+        m->pool_id = 0;
+        m->owner.reset();
+    }
+}
+
+buffer_pool::state::~state()
+{
+    for (std::size_t i = 0; i < arenas.size(); ++i)
+    {
+#if defined(__linux__)
+        if (arenas[i].mapped)
+        {
+            ::munmap(arenas[i].memory, arenas[i].bytes);
+            continue;
+        }
+#endif // defined(__linux__)
+        ::operator delete(arenas[i].memory);
+    }
+}
+
+mutablebuf buffer_pool::acquire(std::size_t size)
+{
+    for (unsigned size_class = 0; size_class < class_count; ++size_class)
+    {
+        if (size <= class_size(size_class))
+            return acquire_class(size_class);
+    }
+    return mutablebuf(mutablebuf::_Ptr(new uint8_t[size], std::default_delete<uint8_t[]>()), size);
+}
+
+mutablebuf buffer_pool::acquire_class(unsigned size_class)
+{
+    state& s = *state_;
+    char* block = 0;
+    thread_magazines* m = find_magazines(s);
+    if (m)
+    {
+        if (m->count[size_class] == 0)
+            refill(s, *m, size_class);
+        block = m->blocks[size_class][--m->count[size_class]];
+    }
+    else
+    {
+        // This thread already caches for too many pools; go to the depot.
+        thread_magazines single;
+        single.count[size_class] = 0;
+        refill(s, single, size_class);
+        block = single.blocks[size_class][--single.count[size_class]];
+        flush(s, single, size_class, 0);
+    }
+
+    uint8_t* data = reinterpret_cast<uint8_t*>(block + header_size);
+    try
+    {
+        return mutablebuf(mutablebuf::_Ptr(data, no_delete(),
+            header_allocator<uint8_t>(&s, size_class, block)), class_size(size_class));
+    }
+    catch (...)
+    {
+        release(&s, size_class, block);
+        throw;
+    }
+}
+
+void buffer_pool::release(state* s, unsigned size_class, char* block)
+{
+    thread_magazines* m = find_magazines(*s);
+    if (m == 0)
+    {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        s->classes[size_class].depot.push_back(block);
+        return;
+    }
+    if (m->count[size_class] == magazine_size)
+        flush(*s, *m, size_class, magazine_size / 2);
+    m->blocks[size_class][m->count[size_class]++] = block;
+}
+
+buffer_pool::thread_cache& buffer_pool::local_cache()
+{
+    static thread_local thread_cache cache;
+    return cache;
+}
+
+bool& buffer_pool::local_cache_destroyed()
+{
+    // Trivially destructible, so it can still be read once the thread's
+    // cache is gone: during thread exit, and for the main thread during
+    // static destruction.
+    static thread_local bool destroyed = false;
+    return destroyed;
+}
+
+buffer_pool::thread_magazines* buffer_pool::find_magazines(state& s)
+{
+    // Without a cache every caller falls back to the depot.
+    if (local_cache_destroyed())
+        return 0;
+    thread_cache& cache = local_cache();
+    thread_magazines* free_slot = 0;
+    for (std::size_t i = 0; i < thread_cache::max_pools; ++i)
+    {
+        thread_magazines& m = cache.pools[i];
+        if (m.pool_id == s.id)
+            return &m;
+        if (free_slot == 0 && (m.pool_id == 0 || m.owner.expired()))
+            free_slot = &m;
+    }
+    if (free_slot)
+    {
+        free_slot->pool_id = s.id;
+        free_slot->owner = s.self;
+        for (unsigned i = 0; i < class_count; ++i)
+            free_slot->count[i] = 0;
+    }
+    return free_slot;
+}
+
+void buffer_pool::flush(state& s, thread_magazines& m, unsigned size_class, std::size_t keep)
+{
+    std::lock_guard<std::mutex> lock(s.mutex);
+    std::vector<char*>& depot = s.classes[size_class].depot;
+    char** blocks = m.blocks[size_class];
+    depot.insert(depot.end(), blocks + keep, blocks + m.count[size_class]);
+    m.count[size_class] = keep;
+}
+
+void buffer_pool::refill(state& s, thread_magazines& m, unsigned size_class)
+{
+    const std::size_t wanted = magazine_size / 2;
+    std::lock_guard<std::mutex> lock(s.mutex);
+    size_class_state& c = s.classes[size_class];
+
+    std::size_t n = c.depot.size() < wanted ? c.depot.size() : wanted;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        m.blocks[size_class][i] = c.depot.back();
+        c.depot.pop_back();
+    }
+
+    const std::size_t stride = class_size(size_class) + header_size;
+    while (n < wanted)
+    {
+        if (static_cast<std::size_t>(c.end - c.next) < stride)
+        {
+            // Carve the next arena. Anything left over in the old one is too
+            // small for this class and stays unused.
+            arena a;
+            a.memory = 0;
+            a.bytes = arena_size;
+            a.mapped = false;
+#if defined(__linux__)
+            if (s.huge_pages)
+            {
+                void* p = ::mmap(0, a.bytes, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (p == MAP_FAILED)
+                {
+                    p = ::mmap(0, a.bytes, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+# if defined(MADV_HUGEPAGE)
+                    if (p != MAP_FAILED)
+                        ::madvise(p, a.bytes, MADV_HUGEPAGE);
+# endif // defined(MADV_HUGEPAGE)
+                }
+                if (p != MAP_FAILED)
+                {
+                    a.memory = p;
+                    a.mapped = true;
+                }
+            }
+#endif // defined(__linux__)
+            if (a.memory == 0)
+            {
+                // Hand out what was already found before reporting failure.
+                try
+                {
+                    a.memory = ::operator new(a.bytes);
+                }
+                catch (...)
+                {
+                    if (n != 0)
+                        break;
+                    throw;
+                }
+            }
+            s.arenas.push_back(a);
+            c.next = static_cast<char*>(a.memory);
+            c.end = c.next + a.bytes;
+        }
+        m.blocks[size_class][n++] = c.next;
+        c.next += stride;
+    }
+    m.count[size_class] = n;
+}
+
+std::size_t buffer_pool::reserved_bytes() const
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->arenas.size() * static_cast<std::size_t>(arena_size);
+}
+
+std::size_t buffer_pool::free_blocks() const
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    std::size_t n = 0;
+    for (unsigned i = 0; i < class_count; ++i)
+        n += state_->classes[i].depot.size();
+    return n;
+}
+
+void buffer_pool::flush_thread_cache()
+{
+    thread_magazines* m = find_magazines(*state_);
+    if (m)
+    {
+        for (unsigned i = 0; i < class_count; ++i)
+            flush(*state_, *m, i, 0);
+    }
+}
+
+buffer_pool::thread_cache::~thread_cache()
+{
+    local_cache_destroyed() = true;
+    for (std::size_t i = 0; i < max_pools; ++i)
+    {
+        std::shared_ptr<state> s = pools[i].owner.lock();
+        if (!s || pools[i].pool_id != s->id)
+            continue;
+        for (unsigned c = 0; c < class_count; ++c)
+            flush(*s, pools[i], c, 0);
+    }
+}
+
+} // namespace NetLite
+
+#endif // END OF NETLITE_BUFFER_POOL_IPP
@@ -21,6 +21,14 @@
  |--------------------------------------------|--------------------------------------------------------------|
  | NETWORK_DISABLE_EVENTFD                    | Disable eventfd if need.                                       |
  |--------------------------------------------|--------------------------------------------------------------|
+ | NETWORK_DISABLE_IO_URING                   | Disable the io_uring io_context.                             |
+ |--------------------------------------------|--------------------------------------------------------------|
+ | NETWORK_DISABLE_SSE2                       | Disable the SSE2 fast paths (e.g. address parsing).          |
+ |--------------------------------------------|--------------------------------------------------------------|
+ | NETWORK_DISABLE_STD_STRING_VIEW            | Disable the std::string_view overloads.                      |
+ |--------------------------------------------|--------------------------------------------------------------|
+ | NETWORK_ENABLE_SOCKET_STATS                | Keep per-socket I/O counters (basic_socket::stats()).        |
+ |--------------------------------------------|--------------------------------------------------------------|
  */
 
 
@@ -91,7 +99,44 @@
 #   endif // (__GLIBC__ > 2) || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 8)
 #  endif // defined(NETWORK_HAS_EPOLL)
 # endif // !defined(NETWORK_HAS_TIMERFD)
+
+// Multishot accept, multishot recv and provided buffer rings need the
+// io_uring interface of Linux 6.0.
+# if !defined(NETWORK_HAS_IO_URING)
+#  if !defined(NETWORK_DISABLE_IO_URING)
+#   if defined(__has_include)
+#    if __has_include(<linux/io_uring.h>)
+#     if LINUX_VERSION_CODE >= KERNEL_VERSION(6,0,0)
+#      define NETWORK_HAS_IO_URING 1
+#     endif // LINUX_VERSION_CODE >= KERNEL_VERSION(6,0,0)
+#    endif // __has_include(<linux/io_uring.h>)
+#   endif // defined(__has_include)
+#  endif // !defined(NETWORK_DISABLE_IO_URING)
+# endif // !defined(NETWORK_HAS_IO_URING)
+
+// TCP_INFO. Newer kernels append fields; older ones fill a shorter prefix.
+# if !defined(NETWORK_HAS_TCP_INFO)
+#  define NETWORK_HAS_TCP_INFO 1
+# endif // !defined(NETWORK_HAS_TCP_INFO)
 #endif // defined(__linux__)
 
+// SSE2 intrinsics, always present on x86-64.
+#if !defined(NETWORK_HAS_SSE2)
+# if !defined(NETWORK_DISABLE_SSE2)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#   define NETWORK_HAS_SSE2 1
+#  endif // defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+# endif // !defined(NETWORK_DISABLE_SSE2)
+#endif // !defined(NETWORK_HAS_SSE2)
+
+// Standard library support for std::string_view.
+#if !defined(NETWORK_HAS_STD_STRING_VIEW)
+# if !defined(NETWORK_DISABLE_STD_STRING_VIEW)
+#  if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L))
+#   define NETWORK_HAS_STD_STRING_VIEW 1
+#  endif // (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L))
+# endif // !defined(NETWORK_DISABLE_STD_STRING_VIEW)
+#endif // !defined(NETWORK_HAS_STD_STRING_VIEW)
+
 
 #endif // END OF NETLITE_CONFIG_HPP
@@ -0,0 +1,223 @@
+#ifndef NETLITE_ADDRESS_FORMATTER_HPP
+#define NETLITE_ADDRESS_FORMATTER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstddef>
+#include <cstring>
+#include "NetLite/config.hpp"
+#include "NetLite/socket_types.hpp"
+
+namespace NetLite{
+namespace detail{
+
+/**
+ * Binary to text conversion of IP addresses.
+ *
+ * The formatters write into a caller supplied [first, last) range and never
+ * allocate. They produce the same text as POSIX inet_ntop: dotted decimal for
+ * IPv4, and lower-case hexadecimal with the longest run of two or more zero
+ * groups compressed to "::" (RFC 5952) for IPv6, with IPv4-mapped and
+ * IPv4-compatible addresses ending in a dotted quad. No null terminator is
+ * written.
+ */
+class address_formatter
+{
+public:
+    /// Longest IPv4 text, "255.255.255.255".
+    enum { max_v4_length = 15 };
+
+    /// Longest IPv6 text without a scope suffix.
+    enum { max_v6_length = 45 };
+
+    /**
+     * Format four bytes in network byte order.
+     * @returns One past the last character written, or a null pointer if the
+     * range is too small.
+     */
+    static char* format_v4(const unsigned char* bytes, char* first, char* last)
+    {
+        char buffer[max_v4_length];
+        char* p = buffer;
+        p = write_octet(p, bytes[0]);
+        *p++ = '.';
+        p = write_octet(p, bytes[1]);
+        *p++ = '.';
+        p = write_octet(p, bytes[2]);
+        *p++ = '.';
+        p = write_octet(p, bytes[3]);
+        return copy_out(buffer, p, first, last);
+    }
+
+    /**
+     * Format sixteen bytes in network byte order, followed by "%scope" when
+     * the scope ID is not zero. The scope is written as an interface name for
+     * link-local addresses when the name is known, otherwise as a number.
+     * @returns One past the last character written, or a null pointer if the
+     * range is too small.
+     */
+    static char* format_v6(const unsigned char* bytes, unsigned long scope_id, char* first, char* last)
+    {
+        unsigned int words[8];
+        for (int i = 0; i < 8; ++i)
+            words[i] = (static_cast<unsigned int>(bytes[2 * i]) << 8) | bytes[2 * i + 1];
+
+        // Find the longest run of zero groups; runs of one are not compressed.
+        int best_base = -1, best_len = 0;
+        for (int i = 0; i < 8;)
+        {
+            if (words[i] != 0)
+            {
+                ++i;
+                continue;
+            }
+            int j = i;
+            while (j < 8 && words[j] == 0)
+                ++j;
+            if (j - i > best_len)
+            {
+                best_base = i;
+                best_len = j - i;
+            }
+            i = j;
+        }
+        if (best_len < 2)
+            best_base = -1;
+
+        char buffer[max_v6_length + 1 + 3 * sizeof(unsigned long) + IF_NAMESIZE];
+        char* p = buffer;
+        for (int i = 0; i < 8; ++i)
+        {
+            if (best_base != -1 && i >= best_base && i < best_base + best_len)
+            {
+                if (i == best_base)
+                    *p++ = ':';
+                continue;
+            }
+            if (i != 0)
+                *p++ = ':';
+            // IPv4-compatible (::a.b.c.d) or IPv4-mapped (::ffff:a.b.c.d).
+            if (i == 6 && best_base == 0
+                && (best_len == 6 || (best_len == 5 && words[5] == 0xffff)))
+            {
+                p = write_octet(p, bytes[12]);
+                *p++ = '.';
+                p = write_octet(p, bytes[13]);
+                *p++ = '.';
+                p = write_octet(p, bytes[14]);
+                *p++ = '.';
+                p = write_octet(p, bytes[15]);
+                break;
+            }
+            p = write_hex_group(p, words[i]);
+        }
+        if (best_base != -1 && best_base + best_len == 8)
+            *p++ = ':';
+
+        if (scope_id != 0)
+        {
+            *p++ = '%';
+            p = write_scope(p, bytes, scope_id);
+        }
+        return copy_out(buffer, p, first, last);
+    }
+
+private:
+    // Two decimal digits for each value below 100.
+    static const char* decimal_pairs()
+    {
+        static const char table[] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+        return table;
+    }
+
+    static char* write_octet(char* p, unsigned int value)
+    {
+        const char* pairs = decimal_pairs();
+        if (value >= 100)
+        {
+            *p++ = static_cast<char>('0' + value / 100);
+            value %= 100;
+            *p++ = pairs[2 * value];
+            *p++ = pairs[2 * value + 1];
+        }
+        else if (value >= 10)
+        {
+            *p++ = pairs[2 * value];
+            *p++ = pairs[2 * value + 1];
+        }
+        else
+        {
+            *p++ = static_cast<char>('0' + value);
+        }
+        return p;
+    }
+
+    static char* write_hex_group(char* p, unsigned int value)
+    {
+        static const char digits[] = "0123456789abcdef";
+        if (value >= 0x1000)
+            *p++ = digits[value >> 12];
+        if (value >= 0x100)
+            *p++ = digits[(value >> 8) & 0xF];
+        if (value >= 0x10)
+            *p++ = digits[(value >> 4) & 0xF];
+        *p++ = digits[value & 0xF];
+        return p;
+    }
+
+    static char* write_scope(char* p, const unsigned char* bytes, unsigned long scope_id)
+    {
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+        const bool is_link_local = (bytes[0] == 0xfe) && ((bytes[1] & 0xc0) == 0x80);
+        const bool is_multicast_link_local = (bytes[0] == 0xff) && ((bytes[1] & 0x0f) == 0x02);
+        if (is_link_local || is_multicast_link_local)
+        {
+            char if_name[IF_NAMESIZE + 1] = { 0 };
+            if (if_indextoname(static_cast<unsigned>(scope_id), if_name) != 0)
+            {
+                const std::size_t length = std::strlen(if_name);
+                std::memcpy(p, if_name, length);
+                return p + length;
+            }
+        }
+#else // !defined(_WIN32) && !defined(__CYGWIN__)
+        (void)bytes;
+#endif // !defined(_WIN32) && !defined(__CYGWIN__)
+        char digits[3 * sizeof(unsigned long)];
+        char* d = digits + sizeof(digits);
+        do
+        {
+            *--d = static_cast<char>('0' + scope_id % 10);
+            scope_id /= 10;
+        } while (scope_id != 0);
+        const std::size_t length = static_cast<std::size_t>(digits + sizeof(digits) - d);
+        std::memcpy(p, d, length);
+        return p + length;
+    }
+
+    static char* copy_out(const char* begin, const char* end, char* first, char* last)
+    {
+        const std::size_t length = static_cast<std::size_t>(end - begin);
+        if (static_cast<std::size_t>(last - first) < length)
+            return 0;
+        std::memcpy(first, begin, length);
+        return first + length;
+    }
+};
+
+} // namespace detail
+} // namespace NetLite
+
+#endif // END OF NETLITE_ADDRESS_FORMATTER_HPP
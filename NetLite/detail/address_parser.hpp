@@ -0,0 +1,337 @@
+#ifndef NETLITE_ADDRESS_PARSER_HPP
+#define NETLITE_ADDRESS_PARSER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include "NetLite/config.hpp"
+#include "NetLite/socket_types.hpp"
+
+#if defined(NETWORK_HAS_SSE2)
+# include <emmintrin.h>
+#endif // defined(NETWORK_HAS_SSE2)
+
+#if defined(_MSC_VER)
+# include <intrin.h>
+#endif // defined(_MSC_VER)
+
+namespace NetLite{
+namespace detail{
+
+/**
+ * Text to binary conversion of IP addresses.
+ *
+ * The parsers work on a [first, last) range, so they need neither a null
+ * terminator nor a temporary string. They accept exactly what POSIX inet_pton
+ * accepts: four decimal octets without leading zeros for IPv4, and the RFC 4291
+ * forms (with at most one "::" and an optional trailing dotted quad) for IPv6.
+ */
+class address_parser
+{
+public:
+    /// Parse an IPv4 address into four bytes in network byte order.
+    static bool parse_v4(const char* first, const char* last, unsigned char* bytes)
+    {
+        const std::size_t length = static_cast<std::size_t>(last - first);
+#if defined(NETWORK_HAS_SSE2)
+        // The vector path loads 8 bytes from each end, so the shortest form,
+        // "1.2.3.4", stays on the scalar path.
+        if (length >= 8 && length <= 15)
+            return parse_v4_sse2(first, length, bytes);
+#endif // defined(NETWORK_HAS_SSE2)
+        if (length < 7 || length > 15)
+            return false;
+        return parse_v4_scalar(first, last, bytes);
+    }
+
+    /// Parse an IPv6 address without a scope suffix into sixteen bytes.
+    static bool parse_v6(const char* first, const char* last, unsigned char* bytes)
+    {
+        unsigned char tmp[16] = { 0 };
+        unsigned char* tp = tmp;
+        unsigned char* const endp = tmp + 16;
+        unsigned char* colonp = 0;
+
+        // A leading ':' is only valid as part of "::".
+        if (first == last)
+            return false;
+        if (*first == ':')
+        {
+            if (++first == last || *first != ':')
+                return false;
+        }
+
+        const char* curtok = first;
+        std::size_t xdigits_seen = 0;
+        unsigned int value = 0;
+        while (first != last)
+        {
+            const unsigned char ch = static_cast<unsigned char>(*first++);
+            const unsigned char digit = hex_table()[ch];
+            if (digit < 16)
+            {
+                if (xdigits_seen == 4)
+                    return false;
+                value = (value << 4) | digit;
+                ++xdigits_seen;
+                continue;
+            }
+            if (ch == ':')
+            {
+                curtok = first;
+                if (xdigits_seen == 0)
+                {
+                    if (colonp)
+                        return false;
+                    colonp = tp;
+                    continue;
+                }
+                if (first == last || tp + 2 > endp)
+                    return false;
+                *tp++ = static_cast<unsigned char>(value >> 8);
+                *tp++ = static_cast<unsigned char>(value);
+                xdigits_seen = 0;
+                value = 0;
+                continue;
+            }
+            // A trailing dotted quad occupies the last four bytes.
+            if (ch == '.' && tp + 4 <= endp && parse_v4(curtok, last, tp))
+            {
+                tp += 4;
+                xdigits_seen = 0;
+                break;
+            }
+            return false;
+        }
+
+        if (xdigits_seen > 0)
+        {
+            if (tp + 2 > endp)
+                return false;
+            *tp++ = static_cast<unsigned char>(value >> 8);
+            *tp++ = static_cast<unsigned char>(value);
+        }
+
+        if (colonp)
+        {
+            // "::" must expand to at least one zero group.
+            if (tp == endp)
+                return false;
+            const std::size_t n = static_cast<std::size_t>(tp - colonp);
+            std::memmove(endp - n, colonp, n);
+            std::memset(colonp, 0, static_cast<std::size_t>(endp - n - colonp));
+            tp = endp;
+        }
+
+        if (tp != endp)
+            return false;
+        std::memcpy(bytes, tmp, 16);
+        return true;
+    }
+
+    /**
+     * Parse an IPv6 address with an optional "%scope" suffix.
+     *
+     * The scope is resolved the same way socket_ops::inet_pton does: as an
+     * interface name for link-local addresses, otherwise as a number.
+     */
+    static bool parse_v6(const char* first, const char* last,
+        unsigned char* bytes, unsigned long* scope_id)
+    {
+        const char* percent = static_cast<const char*>(
+            std::memchr(first, '%', static_cast<std::size_t>(last - first)));
+        if (!parse_v6(first, percent ? percent : last, bytes))
+            return false;
+
+        *scope_id = 0;
+        if (percent)
+        {
+            char if_name[IF_NAMESIZE + 1] = { 0 };
+            std::size_t if_name_len = static_cast<std::size_t>(last - percent - 1);
+            if (if_name_len > IF_NAMESIZE)
+                if_name_len = IF_NAMESIZE;
+            std::memcpy(if_name, percent + 1, if_name_len);
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+            const bool is_link_local = (bytes[0] == 0xfe) && ((bytes[1] & 0xc0) == 0x80);
+            const bool is_multicast_link_local = (bytes[0] == 0xff) && ((bytes[1] & 0x0f) == 0x02);
+            if (is_link_local || is_multicast_link_local)
+                *scope_id = if_nametoindex(if_name);
+#endif // !defined(_WIN32) && !defined(__CYGWIN__)
+            if (*scope_id == 0)
+                *scope_id = static_cast<unsigned long>(std::atoi(if_name));
+        }
+        return true;
+    }
+
+private:
+    // Maps a character to its hexadecimal value, or 0xFF for non-digits.
+    static const unsigned char* hex_table()
+    {
+        static const unsigned char table[256] =
+        {
+#define NETLITE_X16 0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF
+            NETLITE_X16, NETLITE_X16, NETLITE_X16,
+            0,1,2,3,4,5,6,7,8,9,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+            0xFF,10,11,12,13,14,15,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+            NETLITE_X16,
+            0xFF,10,11,12,13,14,15,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+            NETLITE_X16,
+            NETLITE_X16, NETLITE_X16, NETLITE_X16, NETLITE_X16,
+            NETLITE_X16, NETLITE_X16, NETLITE_X16, NETLITE_X16
+#undef NETLITE_X16
+        };
+        return table;
+    }
+
+    // Convert one to three decimal digits, rejecting leading zeros and
+    // values above 255.
+    static bool parse_octet(const unsigned char* p, std::size_t n, unsigned char* octet)
+    {
+        unsigned int value;
+        switch (n)
+        {
+        case 1:
+            value = p[0] - '0';
+            break;
+        case 2:
+            if (p[0] == '0')
+                return false;
+            value = (p[0] - '0') * 10 + (p[1] - '0');
+            break;
+        case 3:
+            if (p[0] == '0')
+                return false;
+            value = (p[0] - '0') * 100 + (p[1] - '0') * 10 + (p[2] - '0');
+            if (value > 255)
+                return false;
+            break;
+        default:
+            return false;
+        }
+        *octet = static_cast<unsigned char>(value);
+        return true;
+    }
+
+    static bool parse_v4_scalar(const char* first, const char* last, unsigned char* bytes)
+    {
+        unsigned char tmp[4];
+        std::size_t octets = 0;
+        const char* start = first;
+        for (const char* p = first; ; ++p)
+        {
+            if (p == last || *p == '.')
+            {
+                if (octets == 4 || !parse_octet(reinterpret_cast<const unsigned char*>(start),
+                    static_cast<std::size_t>(p - start), &tmp[octets]))
+                    return false;
+                ++octets;
+                if (p == last)
+                    break;
+                start = p + 1;
+            }
+            else if (static_cast<unsigned char>(*p - '0') > 9)
+            {
+                return false;
+            }
+        }
+        if (octets != 4)
+            return false;
+        std::memcpy(bytes, tmp, 4);
+        return true;
+    }
+
+#if defined(NETWORK_HAS_SSE2)
+    static unsigned int count_trailing_zeros(unsigned int mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned int>(index);
+#else // defined(_MSC_VER)
+        return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif // defined(_MSC_VER)
+    }
+
+    // Classify all characters at once: every byte must be a digit or a dot,
+    // and the dot mask gives the field boundaries directly. The text is 8 to
+    // 15 bytes long, so it is covered by two overlapping 8-byte loads that
+    // never read outside [first, first + length).
+    static bool parse_v4_sse2(const char* first, std::size_t length, unsigned char* bytes)
+    {
+        const std::size_t shift = length - 8;
+        long long head, tail;
+        std::memcpy(&head, first, 8);
+        std::memcpy(&tail, first + shift, 8);
+        const __m128i input = _mm_set_epi64x(tail, head);
+        const __m128i digits = _mm_and_si128(
+            _mm_cmpgt_epi8(input, _mm_set1_epi8('0' - 1)),
+            _mm_cmplt_epi8(input, _mm_set1_epi8('9' + 1)));
+        const __m128i dots = _mm_cmpeq_epi8(input, _mm_set1_epi8('.'));
+
+        // Fold the two halves back into one bit per character.
+        const unsigned int valid = (1u << length) - 1;
+        const unsigned int digit_bits = static_cast<unsigned int>(_mm_movemask_epi8(digits));
+        const unsigned int dot_bits = static_cast<unsigned int>(_mm_movemask_epi8(dots));
+        const unsigned int digit_mask = ((digit_bits & 0xFF) | ((digit_bits >> 8) << shift)) & valid;
+        unsigned int dot_mask = ((dot_bits & 0xFF) | ((dot_bits >> 8) << shift)) & valid;
+        if ((digit_mask | dot_mask) != valid)
+            return false;
+
+        // Exactly three dots, none of them leading or trailing.
+        if (dot_mask == 0 || (dot_mask & 1) || (dot_mask >> (length - 1)))
+            return false;
+        unsigned int ends[4];
+        ends[0] = count_trailing_zeros(dot_mask);
+        dot_mask &= dot_mask - 1;
+        if (dot_mask == 0)
+            return false;
+        ends[1] = count_trailing_zeros(dot_mask);
+        dot_mask &= dot_mask - 1;
+        if (dot_mask == 0)
+            return false;
+        ends[2] = count_trailing_zeros(dot_mask);
+        dot_mask &= dot_mask - 1;
+        if (dot_mask != 0)
+            return false;
+        ends[3] = static_cast<unsigned int>(length);
+
+        // Digit values with dots zeroed, behind three bytes of padding so the
+        // octets can be converted without branching on their width.
+        unsigned char halves[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(halves),
+            _mm_and_si128(_mm_sub_epi8(input, _mm_set1_epi8('0')), digits));
+        unsigned char values[3 + 16] = { 0 };
+        std::memcpy(values + 3, halves, 8);
+        std::memcpy(values + 3 + shift, halves + 8, 8);
+
+        unsigned char tmp[4];
+        unsigned int start = 0;
+        bool ok = true;
+        for (std::size_t octet = 0; octet < 4; ++octet)
+        {
+            const unsigned int end = ends[octet];
+            const unsigned int n = end - start;
+            const unsigned char* v = values + 3 + end;
+            const unsigned int value = v[-1]
+                + (n >= 2 ? 10u * v[-2] : 0u)
+                + (n >= 3 ? 100u * v[-3] : 0u);
+            ok &= (n >= 1) & (n <= 3) & (value <= 255) & !((n > 1) & (values[3 + start] == 0));
+            tmp[octet] = static_cast<unsigned char>(value);
+            start = end + 1;
+        }
+        if (!ok)
+            return false;
+        std::memcpy(bytes, tmp, 4);
+        return true;
+    }
+#endif // defined(NETWORK_HAS_SSE2)
+};
+
+} // namespace detail
+} // namespace NetLite
+
+#endif // END OF NETLITE_ADDRESS_PARSER_HPP
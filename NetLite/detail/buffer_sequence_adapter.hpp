@@ -1,3 +1,10 @@
+#ifndef NETLITE_BUFFER_SEQUENCE_ADAPTER_HPP
+#define NETLITE_BUFFER_SEQUENCE_ADAPTER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
 
 #include <vector>
 #include "NetLite/socket_types.hpp"
@@ -103,4 +110,6 @@ private:
     std::size_t count_;
     std::size_t total_buffer_size_;
 };
-} // namespace NetLite
\ No newline at end of file
+} // namespace NetLite
+
+#endif // END OF NETLITE_BUFFER_SEQUENCE_ADAPTER_HPP
@@ -0,0 +1,73 @@
+#ifndef NETLITE_HASH_HPP
+#define NETLITE_HASH_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "NetLite/config.hpp"
+#include "NetLite/socket_types.hpp"
+
+namespace NetLite{
+namespace detail{
+
+/**
+ * Scramble a 64-bit word so every input bit affects every output bit
+ * (the MurmurHash3 finalizer).
+ */
+inline uint64_t hash_mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+/// Fold another word into a running hash.
+inline uint64_t hash_combine(uint64_t seed, uint64_t value)
+{
+    return hash_mix(seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2)));
+}
+
+/// Hash an IPv4 address given as a 32-bit word in either byte order.
+inline std::size_t hash_in4(uint32_t addr)
+{
+    return static_cast<std::size_t>(hash_mix(addr));
+}
+
+/// Hash the sixteen bytes of an IPv6 address and its scope ID.
+inline std::size_t hash_in6(const unsigned char* bytes, unsigned long scope_id)
+{
+    uint64_t high, low;
+    std::memcpy(&high, bytes, 8);
+    std::memcpy(&low, bytes + 8, 8);
+    return static_cast<std::size_t>(hash_combine(hash_combine(hash_mix(high), low), scope_id));
+}
+
+/**
+ * Hash an AF_INET or AF_INET6 socket address from its raw fields: the port
+ * and address, plus the scope ID for IPv6. The IPv6 flow label and the IPv4
+ * padding are ignored, matching endpoint equality.
+ */
+inline std::size_t hash_sockaddr(const socket_addr_type* addr)
+{
+    if (addr->sa_family == NET_OS_DEF(AF_INET))
+    {
+        const sockaddr_in4_type* v4 = reinterpret_cast<const sockaddr_in4_type*>(addr);
+        return static_cast<std::size_t>(hash_mix(
+            (static_cast<uint64_t>(v4->sin_port) << 32) | static_cast<uint32_t>(v4->sin_addr.s_addr)));
+    }
+    const sockaddr_in6_type* v6 = reinterpret_cast<const sockaddr_in6_type*>(addr);
+    return static_cast<std::size_t>(hash_combine(
+        hash_in6(v6->sin6_addr.s6_addr, v6->sin6_scope_id), v6->sin6_port));
+}
+
+} // namespace detail
+} // namespace NetLite
+
+#endif // END OF NETLITE_HASH_HPP
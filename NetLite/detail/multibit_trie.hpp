@@ -0,0 +1,253 @@
+#ifndef NETLITE_MULTIBIT_TRIE_HPP
+#define NETLITE_MULTIBIT_TRIE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "NetLite/config.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+# include <xmmintrin.h>
+# define NETLITE_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char*>(addr), _MM_HINT_T0)
+#elif defined(__GNUC__) || defined(__clang__)
+# define NETLITE_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+# define NETLITE_PREFETCH(addr) ((void)(addr))
+#endif
+
+namespace NetLite{
+namespace detail{
+
+/**
+ * Leaf-pushed multibit trie over keys of KeyBytes bytes, used for longest
+ * prefix matching.
+ *
+ * The first level is indexed by the leading 16 bits of the key and every
+ * further level by one more byte, so an IPv4 lookup touches at most three
+ * slots (the DIR-16-8-8 layout) and an IPv6 lookup one slot per byte after the
+ * first two. A slot is a 32-bit word holding either a child table index
+ * (child_flag set) or a value, where 0 means "no match". Prefixes are expanded
+ * into every slot they cover and pushed down into child tables, so a lookup
+ * never backtracks: the slot where the walk stops holds the answer.
+ *
+ * The prefix length owning each slot is kept in a parallel array that is only
+ * read while updating.
+ */
+template <std::size_t KeyBytes>
+class multibit_trie
+{
+public:
+    enum { root_size = 1 << 16, chunk_size = 256, batch_size = 16 };
+
+    /// Largest value that can be stored.
+    static const uint32_t max_value = 0x7FFFFFFFu;
+
+    multibit_trie()
+        : root_(root_size, 0)
+        , root_lengths_(root_size, 0)
+    {
+    }
+
+    /**
+     * Store a non-zero value for the prefix of the given length. Slots that
+     * are already owned by a longer prefix keep their value.
+     */
+    void assign(const unsigned char* key, unsigned int length, uint32_t value)
+    {
+        std::size_t first, count;
+        const long table = descend(key, length, first, count);
+        for (std::size_t i = first; i < first + count; ++i)
+            fill(table, i, length, value);
+    }
+
+    /**
+     * Hand the slots owned by exactly the given prefix over to another value
+     * and prefix length. Used to remove a prefix in favour of the longest
+     * prefix covering it, or of 0 when there is none.
+     */
+    void reassign(const unsigned char* key, unsigned int length,
+        uint32_t value, unsigned int value_length)
+    {
+        std::size_t first, count;
+        const long table = descend(key, length, first, count);
+        for (std::size_t i = first; i < first + count; ++i)
+            replace(table, i, length, value, value_length);
+    }
+
+    /// Get the value of the longest prefix matching the key, or 0.
+    uint32_t lookup(const unsigned char* key) const
+    {
+        uint32_t s = root_[(static_cast<std::size_t>(key[0]) << 8) | key[1]];
+        for (std::size_t level = 1; s & child_flag; ++level)
+            s = chunks_[(s & ~child_flag) * chunk_size + key[level + 1]];
+        return s;
+    }
+
+    /**
+     * Look up count keys stored back to back. The keys are walked in groups,
+     * one level at a time, and the slots of the next level are prefetched for
+     * the whole group before any of them is read.
+     */
+    void lookup(const unsigned char* keys, std::size_t count, uint32_t* results) const
+    {
+        for (std::size_t base = 0; base < count; base += batch_size)
+        {
+            const std::size_t n = (count - base < batch_size) ? count - base : static_cast<std::size_t>(batch_size);
+            const unsigned char* group = keys + base * KeyBytes;
+            uint32_t* out = results + base;
+
+            std::size_t index[batch_size];
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                const unsigned char* key = group + j * KeyBytes;
+                index[j] = (static_cast<std::size_t>(key[0]) << 8) | key[1];
+                NETLITE_PREFETCH(&root_[index[j]]);
+            }
+
+            bool pending = false;
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                out[j] = root_[index[j]];
+                if (out[j] & child_flag)
+                {
+                    index[j] = (out[j] & ~child_flag) * chunk_size + group[j * KeyBytes + 2];
+                    NETLITE_PREFETCH(&chunks_[index[j]]);
+                    pending = true;
+                }
+            }
+
+            for (std::size_t level = 2; pending; ++level)
+            {
+                pending = false;
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    if (!(out[j] & child_flag))
+                        continue;
+                    out[j] = chunks_[index[j]];
+                    if (out[j] & child_flag)
+                    {
+                        index[j] = (out[j] & ~child_flag) * chunk_size + group[j * KeyBytes + level + 1];
+                        NETLITE_PREFETCH(&chunks_[index[j]]);
+                        pending = true;
+                    }
+                }
+            }
+        }
+    }
+
+    /// Remove all prefixes.
+    void clear()
+    {
+        root_.assign(root_size, 0);
+        root_lengths_.assign(root_size, 0);
+        chunks_.clear();
+        chunk_lengths_.clear();
+    }
+
+    /// Get the number of bytes used by the lookup and update tables.
+    std::size_t memory_usage() const
+    {
+        return (root_.size() + chunks_.size()) * sizeof(uint32_t)
+            + root_lengths_.size() + chunk_lengths_.size();
+    }
+
+private:
+    static const uint32_t child_flag = 0x80000000u;
+
+    uint32_t& slot(long table, std::size_t i)
+    {
+        return table < 0 ? root_[i] : chunks_[static_cast<std::size_t>(table) * chunk_size + i];
+    }
+
+    unsigned char& slot_length(long table, std::size_t i)
+    {
+        return table < 0 ? root_lengths_[i] : chunk_lengths_[static_cast<std::size_t>(table) * chunk_size + i];
+    }
+
+    // Walk (and grow) the trie down to the level where the prefix ends, and
+    // return that table together with the range of slots the prefix covers.
+    long descend(const unsigned char* key, unsigned int length,
+        std::size_t& first, std::size_t& count)
+    {
+        long table = -1;
+        unsigned int consumed = 0;
+        for (std::size_t level = 0; ; ++level)
+        {
+            const unsigned int stride = (level == 0) ? 16 : 8;
+            const std::size_t index = (level == 0)
+                ? ((static_cast<std::size_t>(key[0]) << 8) | key[1])
+                : key[level + 1];
+            if (length <= consumed + stride)
+            {
+                const unsigned int free_bits = consumed + stride - length;
+                first = (index >> free_bits) << free_bits;
+                count = static_cast<std::size_t>(1) << free_bits;
+                return table;
+            }
+
+            const uint32_t s = slot(table, index);
+            if (s & child_flag)
+            {
+                table = static_cast<long>(s & ~child_flag);
+            }
+            else
+            {
+                // Push the current slot down into a new child table.
+                const long child = static_cast<long>(chunks_.size() / chunk_size);
+                const unsigned char pushed_length = slot_length(table, index);
+                chunks_.resize(chunks_.size() + chunk_size, s);
+                chunk_lengths_.resize(chunk_lengths_.size() + chunk_size, pushed_length);
+                slot(table, index) = child_flag | static_cast<uint32_t>(child);
+                table = child;
+            }
+            consumed += stride;
+        }
+    }
+
+    void fill(long table, std::size_t i, unsigned int length, uint32_t value)
+    {
+        const uint32_t s = slot(table, i);
+        if (s & child_flag)
+        {
+            const long child = static_cast<long>(s & ~child_flag);
+            for (std::size_t j = 0; j < chunk_size; ++j)
+                fill(child, j, length, value);
+        }
+        else if (slot_length(table, i) <= length)
+        {
+            slot(table, i) = value;
+            slot_length(table, i) = static_cast<unsigned char>(length);
+        }
+    }
+
+    void replace(long table, std::size_t i, unsigned int length,
+        uint32_t value, unsigned int value_length)
+    {
+        const uint32_t s = slot(table, i);
+        if (s & child_flag)
+        {
+            const long child = static_cast<long>(s & ~child_flag);
+            for (std::size_t j = 0; j < chunk_size; ++j)
+                replace(child, j, length, value, value_length);
+        }
+        else if (slot_length(table, i) == length)
+        {
+            slot(table, i) = value;
+            slot_length(table, i) = static_cast<unsigned char>(value_length);
+        }
+    }
+
+    std::vector<uint32_t> root_;
+    std::vector<unsigned char> root_lengths_;
+    std::vector<uint32_t> chunks_;
+    std::vector<unsigned char> chunk_lengths_;
+};
+
+} // namespace detail
+} // namespace NetLite
+
+#endif // END OF NETLITE_MULTIBIT_TRIE_HPP
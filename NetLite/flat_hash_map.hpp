@@ -0,0 +1,562 @@
+#ifndef NETLITE_FLAT_HASH_MAP_HPP
+#define NETLITE_FLAT_HASH_MAP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "NetLite/config.hpp"
+
+namespace NetLite{
+
+/**
+ * An unordered map storing its elements in one flat array, with open
+ * addressing and linear probing.
+ *
+ * Next to the elements is an array of one control byte per slot: zero for an
+ * empty slot, otherwise the high bit plus seven bits of the key's hash. A
+ * lookup scans the control bytes from the key's home slot and only compares
+ * keys whose hash bits match, so a miss rarely touches the elements at all.
+ * Erasing shifts the following elements of the probe sequence back instead of
+ * leaving tombstones, keeping probe sequences short in tables with churn such
+ * as per-peer connection or rate-limit tables.
+ *
+ * The capacity is always a power of two and the table grows when it would
+ * become more than 7/8 full. Inserting or erasing invalidates iterators,
+ * pointers and references to elements.
+ *
+ * @par Example
+ * @code
+ * NetLite::flat_hash_map<NetLite::tcp::endpoint, unsigned> requests;
+ * ++requests[socket.remote_endpoint()];
+ * @endcode
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+template <typename Key, typename T,
+    typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key> >
+class flat_hash_map
+{
+public:
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef std::pair<const Key, T> value_type;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef Hash hasher;
+    typedef KeyEqual key_equal;
+    typedef value_type& reference;
+    typedef const value_type& const_reference;
+
+private:
+    template <typename Value, typename Map>
+    class basic_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename std::remove_const<Value>::type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Value* pointer;
+        typedef Value& reference;
+
+        basic_iterator() noexcept
+            : map_(0)
+            , index_(0)
+        {
+        }
+
+        /// Convert an iterator to a const_iterator.
+        template <typename OtherValue, typename OtherMap>
+        basic_iterator(const basic_iterator<OtherValue, OtherMap>& other) noexcept
+            : map_(other.map_)
+            , index_(other.index_)
+        {
+        }
+
+        reference operator*() const
+        {
+            return *map_->element(index_);
+        }
+
+        pointer operator->() const
+        {
+            return map_->element(index_);
+        }
+
+        basic_iterator& operator++()
+        {
+            index_ = map_->next_used(index_ + 1);
+            return *this;
+        }
+
+        basic_iterator operator++(int)
+        {
+            basic_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        friend bool operator==(const basic_iterator& a, const basic_iterator& b)
+        {
+            return a.index_ == b.index_;
+        }
+
+        friend bool operator!=(const basic_iterator& a, const basic_iterator& b)
+        {
+            return a.index_ != b.index_;
+        }
+
+    private:
+        friend class flat_hash_map;
+        template <typename, typename> friend class basic_iterator;
+
+        basic_iterator(Map* map, size_type index) noexcept
+            : map_(map)
+            , index_(index)
+        {
+        }
+
+        Map* map_;
+        size_type index_;
+    };
+
+public:
+    typedef basic_iterator<value_type, flat_hash_map> iterator;
+    typedef basic_iterator<const value_type, const flat_hash_map> const_iterator;
+
+    /// Construct an empty map.
+    flat_hash_map()
+        : slots_(0)
+        , ctrl_(0)
+        , capacity_(0)
+        , size_(0)
+        , shift_(64)
+    {
+    }
+
+    /// Construct an empty map with room for at least count elements.
+    explicit flat_hash_map(size_type count, const Hash& hash = Hash(),
+        const KeyEqual& equal = KeyEqual())
+        : slots_(0)
+        , ctrl_(0)
+        , capacity_(0)
+        , size_(0)
+        , shift_(64)
+        , hash_(hash)
+        , equal_(equal)
+    {
+        reserve(count);
+    }
+
+    /// Copy constructor.
+    flat_hash_map(const flat_hash_map& other)
+        : slots_(0)
+        , ctrl_(0)
+        , capacity_(0)
+        , size_(0)
+        , shift_(64)
+        , hash_(other.hash_)
+        , equal_(other.equal_)
+    {
+        if (other.size_ == 0)
+            return;
+        allocate(other.capacity_);
+        // Same capacity, so every element keeps its slot.
+        for (size_type i = 0; i < capacity_; ++i)
+        {
+            if (other.ctrl_[i] != 0)
+            {
+                new (element(i)) value_type(*other.element(i));
+                ctrl_[i] = other.ctrl_[i];
+                ++size_;
+            }
+        }
+    }
+
+    /// Move constructor.
+    flat_hash_map(flat_hash_map&& other) noexcept
+        : slots_(other.slots_)
+        , ctrl_(other.ctrl_)
+        , capacity_(other.capacity_)
+        , size_(other.size_)
+        , shift_(other.shift_)
+        , hash_(std::move(other.hash_))
+        , equal_(std::move(other.equal_))
+    {
+        other.slots_ = 0;
+        other.ctrl_ = 0;
+        other.capacity_ = 0;
+        other.size_ = 0;
+        other.shift_ = 64;
+    }
+
+    /// Destructor.
+    ~flat_hash_map()
+    {
+        destroy();
+    }
+
+    /// Assign from another map.
+    flat_hash_map& operator=(const flat_hash_map& other)
+    {
+        if (this != &other)
+        {
+            flat_hash_map tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    /// Move-assign from another map.
+    flat_hash_map& operator=(flat_hash_map&& other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy();
+            slots_ = other.slots_;
+            ctrl_ = other.ctrl_;
+            capacity_ = other.capacity_;
+            size_ = other.size_;
+            shift_ = other.shift_;
+            hash_ = std::move(other.hash_);
+            equal_ = std::move(other.equal_);
+            other.slots_ = 0;
+            other.ctrl_ = 0;
+            other.capacity_ = 0;
+            other.size_ = 0;
+            other.shift_ = 64;
+        }
+        return *this;
+    }
+
+    /// Swap the contents of two maps.
+    void swap(flat_hash_map& other) noexcept
+    {
+        using std::swap;
+        swap(slots_, other.slots_);
+        swap(ctrl_, other.ctrl_);
+        swap(capacity_, other.capacity_);
+        swap(size_, other.size_);
+        swap(shift_, other.shift_);
+        swap(hash_, other.hash_);
+        swap(equal_, other.equal_);
+    }
+
+    iterator begin() noexcept
+    {
+        return iterator(this, next_used(0));
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(this, next_used(0));
+    }
+
+    iterator end() noexcept
+    {
+        return iterator(this, capacity_);
+    }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator(this, capacity_);
+    }
+
+    /// Determine whether the map is empty.
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    /// Get the number of elements.
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    /// Get the number of slots.
+    size_type bucket_count() const noexcept
+    {
+        return capacity_;
+    }
+
+    /// Get the ratio of elements to slots.
+    float load_factor() const noexcept
+    {
+        return capacity_ == 0 ? 0.0f : static_cast<float>(size_) / static_cast<float>(capacity_);
+    }
+
+    /// Remove all elements, keeping the capacity.
+    void clear() noexcept
+    {
+        for (size_type i = 0; i < capacity_; ++i)
+        {
+            if (ctrl_[i] != 0)
+            {
+                element(i)->~value_type();
+                ctrl_[i] = 0;
+            }
+        }
+        size_ = 0;
+    }
+
+    /// Make room for at least count elements without further growth.
+    void reserve(size_type count)
+    {
+        size_type capacity = 16;
+        while (capacity - capacity / 8 < count)
+            capacity *= 2;
+        if (capacity > capacity_)
+            rehash(capacity);
+    }
+
+    /**
+     * Insert an element constructed from args if the key is not present.
+     * @returns An iterator to the element with the key, and whether it was
+     * inserted.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args)
+    {
+        return emplace_key(key, std::forward<Args>(args)...);
+    }
+
+    /**
+     * Insert an element constructed from args if the key is not present.
+     * @returns An iterator to the element with the key, and whether it was
+     * inserted.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args)
+    {
+        return emplace_key(std::move(key), std::forward<Args>(args)...);
+    }
+
+    /// Insert a copy of value if its key is not present.
+    std::pair<iterator, bool> insert(const value_type& value)
+    {
+        return emplace_key(value.first, value.second);
+    }
+
+    /// Insert value if its key is not present.
+    std::pair<iterator, bool> insert(value_type&& value)
+    {
+        return emplace_key(value.first, std::move(value.second));
+    }
+
+    /// Get the element with the key, inserting a value-initialised one if absent.
+    mapped_type& operator[](const key_type& key)
+    {
+        return emplace_key(key).first->second;
+    }
+
+    /// Get the element with the key, inserting a value-initialised one if absent.
+    mapped_type& operator[](key_type&& key)
+    {
+        return emplace_key(std::move(key)).first->second;
+    }
+
+    /// Find the element with the key.
+    iterator find(const key_type& key)
+    {
+        return iterator(this, find_index(key));
+    }
+
+    /// Find the element with the key.
+    const_iterator find(const key_type& key) const
+    {
+        return const_iterator(this, find_index(key));
+    }
+
+    /// Count the elements with the key, 0 or 1.
+    size_type count(const key_type& key) const
+    {
+        return find_index(key) != capacity_ ? 1 : 0;
+    }
+
+    /// Determine whether an element with the key exists.
+    bool contains(const key_type& key) const
+    {
+        return find_index(key) != capacity_;
+    }
+
+    /// Remove the element with the key, returning the number removed.
+    size_type erase(const key_type& key)
+    {
+        const size_type index = find_index(key);
+        if (index == capacity_)
+            return 0;
+        erase_at(index);
+        return 1;
+    }
+
+    /**
+     * Remove the element at pos. Unlike the standard containers this does not
+     * return an iterator, because later elements may be shifted into pos.
+     */
+    void erase(const_iterator pos)
+    {
+        erase_at(pos.index_);
+    }
+
+private:
+    typedef typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type storage_type;
+
+    value_type* element(size_type index) noexcept
+    {
+        return reinterpret_cast<value_type*>(slots_ + index);
+    }
+
+    const value_type* element(size_type index) const noexcept
+    {
+        return reinterpret_cast<const value_type*>(slots_ + index);
+    }
+
+    size_type next_used(size_type index) const noexcept
+    {
+        while (index < capacity_ && ctrl_[index] == 0)
+            ++index;
+        return index;
+    }
+
+    // Fibonacci hashing spreads weak hashes (such as identity hashes of
+    // integers) over the whole table; the low bits give the control tag.
+    size_type home_index(uint64_t h) const noexcept
+    {
+        return static_cast<size_type>((h * 0x9e3779b97f4a7c15ull) >> shift_);
+    }
+
+    static unsigned char tag_of(uint64_t h) noexcept
+    {
+        return static_cast<unsigned char>(0x80 | (h & 0x7F));
+    }
+
+    size_type find_index(const key_type& key) const
+    {
+        if (size_ == 0)
+            return capacity_;
+        const uint64_t h = static_cast<uint64_t>(hash_(key));
+        const unsigned char tag = tag_of(h);
+        const size_type mask = capacity_ - 1;
+        for (size_type i = home_index(h); ; i = (i + 1) & mask)
+        {
+            const unsigned char c = ctrl_[i];
+            if (c == 0)
+                return capacity_;
+            if (c == tag && equal_(element(i)->first, key))
+                return i;
+        }
+    }
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> emplace_key(K&& key, Args&&... args)
+    {
+        size_type index = find_index(key);
+        if (index != capacity_)
+            return std::make_pair(iterator(this, index), false);
+
+        if (size_ + 1 > capacity_ - capacity_ / 8)
+            rehash(capacity_ == 0 ? 16 : capacity_ * 2);
+        const uint64_t h = static_cast<uint64_t>(hash_(key));
+        const size_type mask = capacity_ - 1;
+        index = home_index(h);
+        while (ctrl_[index] != 0)
+            index = (index + 1) & mask;
+        new (element(index)) value_type(std::piecewise_construct,
+            std::forward_as_tuple(std::forward<K>(key)),
+            std::forward_as_tuple(std::forward<Args>(args)...));
+        ctrl_[index] = tag_of(h);
+        ++size_;
+        return std::make_pair(iterator(this, index), true);
+    }
+
+    void erase_at(size_type hole)
+    {
+        element(hole)->~value_type();
+        ctrl_[hole] = 0;
+        --size_;
+
+        // Shift back every following element of the run whose home slot does
+        // not lie between the hole and its current slot.
+        const size_type mask = capacity_ - 1;
+        for (size_type i = (hole + 1) & mask; ctrl_[i] != 0; i = (i + 1) & mask)
+        {
+            const size_type home = home_index(static_cast<uint64_t>(hash_(element(i)->first)));
+            if (((i - home) & mask) >= ((i - hole) & mask))
+            {
+                new (element(hole)) value_type(std::move(*element(i)));
+                ctrl_[hole] = ctrl_[i];
+                element(i)->~value_type();
+                ctrl_[i] = 0;
+                hole = i;
+            }
+        }
+    }
+
+    void allocate(size_type capacity)
+    {
+        slots_ = new storage_type[capacity];
+        ctrl_ = new unsigned char[capacity]();
+        capacity_ = capacity;
+        shift_ = 64;
+        for (size_type c = capacity; c > 1; c >>= 1)
+            --shift_;
+    }
+
+    void rehash(size_type capacity)
+    {
+        storage_type* old_slots = slots_;
+        unsigned char* old_ctrl = ctrl_;
+        const size_type old_capacity = capacity_;
+
+        allocate(capacity);
+        const size_type mask = capacity_ - 1;
+        for (size_type i = 0; i < old_capacity; ++i)
+        {
+            if (old_ctrl[i] == 0)
+                continue;
+            value_type* value = reinterpret_cast<value_type*>(old_slots + i);
+            size_type index = home_index(static_cast<uint64_t>(hash_(value->first)));
+            while (ctrl_[index] != 0)
+                index = (index + 1) & mask;
+            new (element(index)) value_type(std::move(*value));
+            ctrl_[index] = old_ctrl[i];
+            value->~value_type();
+        }
+        delete[] old_slots;
+        delete[] old_ctrl;
+    }
+
+    void destroy() noexcept
+    {
+        clear();
+        delete[] slots_;
+        delete[] ctrl_;
+        slots_ = 0;
+        ctrl_ = 0;
+        capacity_ = 0;
+        shift_ = 64;
+    }
+
+    storage_type* slots_;
+    unsigned char* ctrl_;
+    size_type capacity_;
+    size_type size_;
+    unsigned int shift_;
+    Hash hash_;
+    KeyEqual equal_;
+};
+
+} // namespace NetLite
+
+#endif // END OF NETLITE_FLAT_HASH_MAP_HPP
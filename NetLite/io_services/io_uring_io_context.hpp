@@ -0,0 +1,863 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_IO_URING_IO_CONTEXT_HPP
+#define NETLITE_IO_URING_IO_CONTEXT_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "NetLite/config.hpp"
+
+#if defined(NETWORK_HAS_IO_URING)
+
+#include <linux/io_uring.h>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "NetLite/socket_types.hpp"
+#include "NetLite/socket_ops.hpp"
+#include "NetLite/net_error_code.hpp"
+#include "NetLite/mutablebuf.hpp"
+#include "NetLite/buffer_pool.hpp"
+#include "NetLite/basic_socket.hpp"
+#include "NetLite/write_coalescer.hpp"
+#include "NetLite/io_services/io_uring_operation.hpp"
+#include "NetLite/io_services/loop_metrics.hpp"
+
+namespace NetLite{
+
+/**
+ * An io_context for Linux built directly on io_uring.
+ *
+ * Accepts and receives are multishot: a single submission keeps producing
+ * completions until it is cancelled or fails, so a listening socket or a
+ * connection costs no submission queue entry per event in steady state.
+ * Receives do not take a buffer from the caller. Either the kernel picks one
+ * from a buffer group registered with add_buffer_group() when data arrives,
+ * or the context waits for readiness and then borrows a block from a
+ * buffer_pool. Either way an idle connection holds no memory.
+ *
+ * Handlers are only called from a thread that is inside run(), run_one() or
+ * poll(), and only one thread may do so at a time. post() and stop() may be
+ * called from any thread.
+ *
+ * The loop can time itself: see enable_metrics() and metrics(). It can also
+ * spin before it sleeps: see enable_busy_poll().
+ *
+ * Sockets may coalesce their sends through the context, see
+ * basic_socket::enable_write_coalescing(). Their staged data is sent once
+ * all handlers of a loop iteration have run.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+class io_uring_io_context : public flush_scheduler
+{
+public:
+    /// The type of a handler passed to post().
+    typedef std::function<void()> handler_type;
+
+    /**
+     * Create the ring.
+     *
+     * @param entries The size of the submission queue. The completion queue
+     * is twice as large.
+     *
+     * @throws std::system_error Thrown if the kernel does not provide
+     * io_uring or the ring cannot be created.
+     */
+    NETWORK_API explicit io_uring_io_context(unsigned entries = 256);
+
+    /// Destroy the ring. Outstanding operations are abandoned without
+    /// calling their handlers.
+    NETWORK_API ~io_uring_io_context();
+
+    io_uring_io_context(const io_uring_io_context&) = delete;
+    io_uring_io_context& operator=(const io_uring_io_context&) = delete;
+
+    /**
+     * Register a group of receive buffers with the kernel.
+     *
+     * @param buffer_count The number of buffers, at most 32768.
+     *
+     * @param buffer_size The size of each buffer, which is also the most a
+     * single receive completion delivers.
+     *
+     * @returns The group ID to pass to async_receive().
+     *
+     * @throws std::system_error Thrown on failure.
+     */
+    unsigned short add_buffer_group(std::size_t buffer_count, std::size_t buffer_size)
+    {
+        std::error_code ec;
+        unsigned short group = add_buffer_group(buffer_count, buffer_size, ec);
+        throw_if(ec, "add_buffer_group");
+        return group;
+    }
+
+    /**
+     * Register a group of receive buffers with the kernel.
+     *
+     * @param buffer_count The number of buffers, at most 32768.
+     *
+     * @param buffer_size The size of each buffer, which is also the most a
+     * single receive completion delivers.
+     *
+     * @param ec Set to indicate what error occurred, if any.
+     *
+     * @returns The group ID to pass to async_receive().
+     */
+    NETWORK_API unsigned short add_buffer_group(std::size_t buffer_count,
+        std::size_t buffer_size, std::error_code& ec);
+
+    /**
+     * Start accepting connections on a listening socket.
+     * The handler is called once for every accepted connection until the
+     * operation is cancelled with cancel() or fails. If the kernel ends the
+     * multishot accept on its own, for example because the completion queue
+     * overflowed, it is submitted again without involving the caller.
+     *
+     * @param acceptor A listening socket. It must stay open until the handler
+     * has been called with an error.
+     *
+     * @param handler The handler to be called for each connection. The
+     * function signature of the handler must be:
+     * @code void handler(
+     *   const std::error_code& error,                // Result of operation.
+     *   NetLite::basic_socket<Protocol, Holder> peer // The new connection.
+     * ); @endcode
+     * After an error, including std::errc::operation_canceled, the handler
+     * is not called again. The connections are in non-blocking mode, like
+     * those of basic_socket::accept_batch().
+     */
+    template <typename Protocol, typename Holder, typename Handler>
+    void async_accept(basic_socket<Protocol, Holder>& acceptor, Handler handler)
+    {
+        typedef accept_op<basic_socket<Protocol, Holder>, Handler> op;
+        prepare_busy_poll(acceptor.native_handle());
+
+        // The accepted sockets take the acceptor's address family. If the
+        // acceptor is not a bound socket, the kernel fails the accept.
+        std::error_code ignored_ec;
+        Protocol protocol = acceptor.local_endpoint(ignored_ec).protocol();
+        op* o = new op(acceptor.native_handle(), protocol, std::move(handler));
+        work_started();
+        link_operation(o);
+        start_accept(o->socket_, o);
+    }
+
+    /**
+     * Start receiving on a connected socket.
+     * The handler is called each time data arrives, with a buffer chosen by
+     * the kernel from the given buffer group, until the peer closes the
+     * connection, the operation is cancelled with cancel() or it fails.
+     *
+     * @param socket A connected socket. It must stay open until the handler
+     * has been called for the last time.
+     *
+     * @param buffer_group A group ID returned by add_buffer_group().
+     *
+     * @param handler The handler to be called for each receive. The function
+     * signature of the handler must be:
+     * @code void handler(
+     *   const std::error_code& error, // Result of operation.
+     *   const char* data,             // The received bytes.
+     *   std::size_t size              // Number of bytes received.
+     * ); @endcode
+     * The data is only valid until the handler returns. A size of zero with
+     * no error means the peer closed the connection. After that, or after an
+     * error, the handler is not called again.
+     */
+    template <typename Protocol, typename Holder, typename Handler>
+    void async_receive(basic_socket<Protocol, Holder>& socket, unsigned short buffer_group,
+        Handler handler)
+    {
+        typedef receive_op<Handler> op;
+        prepare_busy_poll(socket.native_handle());
+        op* o = new op(socket.native_handle(), buffer_group, std::move(handler));
+        work_started();
+        link_operation(o);
+        start_receive(o->socket_, buffer_group, o);
+    }
+
+    /**
+     * Start receiving on a connected socket into buffers borrowed from a
+     * pool.
+     * Nothing is attached to the socket while it waits: the operation is a
+     * multishot readiness poll, and only when the socket becomes readable is
+     * a block taken from the pool and filled with a non-blocking receive.
+     * The block goes back to the pool when the handler's buffer, and every
+     * copy of it, is destroyed. The handler is called for each filled block
+     * until the peer closes the connection, the operation is cancelled with
+     * cancel() or it fails. After 16 blocks
+     * in a row the rest is received from a posted handler, so one busy socket
+     * does not hold up the others.
+     *
+     * @param socket A connected socket. It must stay open until the handler
+     * has been called for the last time.
+     *
+     * @param pool The pool to borrow from. It must outlive the operation and
+     * every buffer passed to the handler.
+     *
+     * @param handler The handler to be called for each receive. The function
+     * signature of the handler must be:
+     * @code void handler(
+     *   const std::error_code& error, // Result of operation.
+     *   NetLite::mutablebuf buffer    // The received bytes.
+     * ); @endcode
+     * An empty buffer with no error means the peer closed the connection.
+     * After that, or after an error, the handler is not called again.
+     */
+    template <typename Protocol, typename Holder, typename Handler>
+    void async_receive(basic_socket<Protocol, Holder>& socket, buffer_pool& pool,
+        Handler handler)
+    {
+        typedef pooled_receive_op<Handler> op;
+        prepare_busy_poll(socket.native_handle());
+        op* o = new op(socket.native_handle(), pool, std::move(handler));
+        work_started();
+        link_operation(o);
+        start_poll(o->socket_, o);
+    }
+
+    /**
+     * Cancel all accept and receive operations on a socket.
+     * Their handlers are called with std::errc::operation_canceled from
+     * within run().
+     */
+    NETWORK_API void cancel(socket_type native_socket);
+
+    /// Cancel all accept and receive operations on a socket.
+    template <typename Protocol, typename Holder>
+    void cancel(basic_socket<Protocol, Holder>& socket)
+    {
+        cancel(socket.native_handle());
+    }
+
+    /**
+     * Request the context to invoke the given handler.
+     * The handler is called from within run() and may be posted from any
+     * thread.
+     */
+    NETWORK_API void post(handler_type handler);
+
+    /**
+     * Run the event loop until stopped or no more work.
+     * @returns The number of handlers that were executed.
+     * @throws std::system_error Thrown on failure.
+     */
+    std::size_t run()
+    {
+        std::error_code ec;
+        std::size_t n = run(ec);
+        throw_if(ec, "run");
+        return n;
+    }
+
+    /// Run the event loop until stopped or no more work.
+    NETWORK_API std::size_t run(std::error_code& ec);
+
+    /// Run until stopped or at least one handler was executed.
+    NETWORK_API std::size_t run_one(std::error_code& ec);
+
+    /// Run ready handlers without blocking.
+    NETWORK_API std::size_t poll(std::error_code& ec);
+
+    /// Stop the event loop. run() returns as soon as possible.
+    NETWORK_API void stop();
+
+    /// Determine whether the event loop has been stopped.
+    bool stopped() const
+    {
+        return stopped_.load(std::memory_order_acquire);
+    }
+
+    /// Clear the stopped state so that run() can be called again.
+    void restart()
+    {
+        stopped_.store(false, std::memory_order_release);
+    }
+
+    /**
+     * Start or stop recording loop metrics.
+     * Metrics are off by default. While they are on, the loop reads the
+     * clock around every wait in the kernel and every handler, and post()
+     * stamps each handler with the time it was posted. May be called from
+     * any thread; handlers posted while metrics were off have no post lag.
+     */
+    void enable_metrics(bool enable)
+    {
+        metrics_enabled_.store(enable, std::memory_order_relaxed);
+    }
+
+    /// Determine whether loop metrics are being recorded.
+    bool metrics_enabled() const
+    {
+        return metrics_enabled_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the loop metrics.
+     * May be called from any thread, including while the loop is running.
+     *
+     * @par Example
+     * Watching for handlers that starve the loop:
+     * @code
+     * NetLite::loop_metrics::snapshot m = io.metrics();
+     * if (m.slowest_handlers[0] > 10000000)
+     *     report_stall(m.slowest_handlers[0], m.handler_time.percentile(99));
+     * io.reset_metrics();
+     * @endcode
+     */
+    loop_metrics::snapshot metrics() const
+    {
+        if (metrics_reset_pending_.load(std::memory_order_acquire))
+            return loop_metrics::snapshot();
+        return metrics_.load();
+    }
+
+    /**
+     * Set the loop metrics to zero.
+     * May be called from any thread. The loop thread clears the metrics at
+     * the start of its next iteration, so the reset cannot race with its
+     * updates; until then metrics() reports zeros.
+     */
+    void reset_metrics()
+    {
+        metrics_reset_pending_.store(true, std::memory_order_release);
+    }
+
+    /// Settings of the busy poll mode, see enable_busy_poll().
+    struct busy_poll_options
+    {
+        busy_poll_options()
+            : spin_usec(50)
+            , socket_usec(50)
+            , prefer(true)
+            , budget(0)
+        {
+        }
+
+        /// How long the loop spins on the completion queue before it sleeps
+        /// in the kernel, in microseconds. 0 never spins.
+        unsigned spin_usec;
+
+        /// The SO_BUSY_POLL time of registered sockets, and how long the
+        /// kernel polls their device queues while the loop waits, in
+        /// microseconds. 0 leaves the sockets and the ring alone.
+        unsigned socket_usec;
+
+        /// Set SO_PREFER_BUSY_POLL, so that the device keeps its interrupts
+        /// off while the loop polls often enough.
+        bool prefer;
+
+        /// The SO_BUSY_POLL_BUDGET of registered sockets: the most packets
+        /// handled per poll. 0 keeps the kernel default.
+        unsigned budget;
+    };
+
+    /**
+     * Busy poll instead of sleeping as soon as the loop runs out of work.
+     * The loop first spins on the completion queue for spin_usec, so a
+     * completion that arrives meanwhile is picked up without a wakeup. Only
+     * then does it wait in the kernel, where, if the kernel can busy poll
+     * for io_uring (Linux 6.9), it polls the device queues of the registered
+     * sockets for socket_usec before it sleeps until an interrupt.
+     *
+     * Sockets passed to async_accept() or async_receive() from now on, and
+     * the connections accepted, get SO_BUSY_POLL, SO_PREFER_BUSY_POLL and
+     * SO_BUSY_POLL_BUDGET as the options say. Sockets registered earlier keep
+     * theirs; use apply_busy_poll() on them. Errors setting these are
+     * ignored: SO_PREFER_BUSY_POLL, and an SO_BUSY_POLL above the
+     * net.core.busy_poll sysctl, need CAP_NET_ADMIN.
+     *
+     * Must be called while no thread is inside run(), or from the thread
+     * that is.
+     *
+     * @par Example
+     * A feed handler that owns a core:
+     * @code
+     * NetLite::io_uring_io_context::busy_poll_options options;
+     * options.spin_usec = 200;
+     * io.enable_busy_poll(options);
+     * io.enable_metrics(true);
+     * ...
+     * NetLite::loop_metrics::snapshot m = io.metrics();
+     * double useful = m.spins ? double(m.spin_hits) / double(m.spins) : 0.0;
+     * @endcode
+     * The loop thread then keeps its core busy while idle; the time it spins
+     * shows in loop_metrics::snapshot::spin_ns while metrics are on.
+     */
+    NETWORK_API void enable_busy_poll(const busy_poll_options& options);
+
+    /// Sleep as soon as the loop runs out of work. Socket options already
+    /// set stay as they are.
+    NETWORK_API void disable_busy_poll();
+
+    /// Determine whether the loop busy polls.
+    bool busy_poll_enabled() const
+    {
+        return busy_poll_;
+    }
+
+    /**
+     * Set the busy poll socket options of enable_busy_poll() on a socket.
+     * @throws std::system_error Thrown on failure.
+     */
+    template <typename Protocol, typename Holder>
+    void apply_busy_poll(basic_socket<Protocol, Holder>& socket)
+    {
+        std::error_code ec;
+        apply_busy_poll(socket.native_handle(), ec);
+        throw_if(ec, "apply_busy_poll");
+    }
+
+    /**
+     * Set the busy poll socket options of enable_busy_poll() on a socket.
+     * Does nothing while busy polling is off.
+     *
+     * @param native_socket The socket.
+     *
+     * @param ec Set to indicate what error occurred, if any. The options are
+     * set in order and the first failure stops the rest.
+     */
+    NETWORK_API std::error_code apply_busy_poll(socket_type native_socket, std::error_code& ec);
+
+    /// Flush the coalescer at the end of the current loop iteration. Must
+    /// be called from the thread running the loop.
+    NETWORK_API virtual void schedule_flush(write_coalescer* coalescer);
+
+    /// Forget a coalescer passed to schedule_flush().
+    NETWORK_API virtual void cancel_flush(write_coalescer* coalescer);
+
+private:
+    template <typename Socket, typename Handler>
+    class accept_op : public io_uring_operation
+    {
+    public:
+        accept_op(socket_type s, const typename Socket::protocol_type& protocol, Handler handler)
+            : io_uring_operation(&accept_op::do_complete)
+            , socket_(s)
+            , protocol_(protocol)
+            , handler_(std::move(handler))
+        {
+        }
+
+        static void do_complete(void* owner, io_uring_operation* base, int result, unsigned flags)
+        {
+            accept_op* o = static_cast<accept_op*>(base);
+            if (owner == 0)
+            {
+                delete o;
+                return;
+            }
+
+            io_uring_io_context* ctx = static_cast<io_uring_io_context*>(owner);
+            if (result >= 0)
+            {
+                ctx->prepare_busy_poll(result);
+                std::error_code ec;
+                Socket peer(o->protocol_, result, ec);
+                // Accepted non-blocking, as basic_socket::accept_batch()
+                // does.
+                peer._state |= socket_ops::user_set_non_blocking | socket_ops::internal_non_blocking;
+                o->handler_(ec, std::move(peer));
+                if ((flags & IORING_CQE_F_MORE) == 0)
+                    ctx->start_accept(o->socket_, o);
+                return;
+            }
+            if ((flags & IORING_CQE_F_MORE) != 0)
+                return;
+
+            const std::error_code ec(-result, std::generic_category());
+            ctx->unlink_operation(o);
+            o->handler_(ec, Socket());
+            ctx->work_finished();
+            delete o;
+        }
+
+        socket_type socket_;
+        typename Socket::protocol_type protocol_;
+        Handler handler_;
+    };
+
+    template <typename Handler>
+    class receive_op : public io_uring_operation
+    {
+    public:
+        receive_op(socket_type s, unsigned short buffer_group, Handler handler)
+            : io_uring_operation(&receive_op::do_complete)
+            , socket_(s)
+            , buffer_group_(buffer_group)
+            , handler_(std::move(handler))
+        {
+        }
+
+        static void do_complete(void* owner, io_uring_operation* base, int result, unsigned flags)
+        {
+            receive_op* o = static_cast<receive_op*>(base);
+            if (owner == 0)
+            {
+                delete o;
+                return;
+            }
+
+            io_uring_io_context* ctx = static_cast<io_uring_io_context*>(owner);
+            if (result > 0 && (flags & IORING_CQE_F_BUFFER) != 0)
+            {
+                const unsigned short buffer_id = static_cast<unsigned short>(flags >> IORING_CQE_BUFFER_SHIFT);
+                o->handler_(std::error_code(), ctx->buffer_data(o->buffer_group_, buffer_id),
+                    static_cast<std::size_t>(result));
+                ctx->recycle_buffer(o->buffer_group_, buffer_id);
+                if ((flags & IORING_CQE_F_MORE) == 0)
+                    ctx->start_receive(o->socket_, o->buffer_group_, o);
+                return;
+            }
+            if ((flags & IORING_CQE_F_MORE) != 0)
+                return;
+
+            // The group ran dry. Every buffer goes back as soon as its
+            // handler returns, so there is room again by the time this is
+            // resubmitted.
+            if (result == -ENOBUFS)
+            {
+                ctx->start_receive(o->socket_, o->buffer_group_, o);
+                return;
+            }
+
+            std::error_code ec;
+            if (result < 0)
+                ec = std::error_code(-result, std::generic_category());
+            ctx->unlink_operation(o);
+            o->handler_(ec, static_cast<const char*>(0), 0);
+            ctx->work_finished();
+            delete o;
+        }
+
+        socket_type socket_;
+        unsigned short buffer_group_;
+        Handler handler_;
+    };
+
+    template <typename Handler>
+    class pooled_receive_op : public io_uring_operation
+    {
+    public:
+        // The most blocks one drain() fills before it lets the loop run
+        // other work.
+        enum { max_drain_blocks = 16 };
+
+        pooled_receive_op(socket_type s, buffer_pool& pool, Handler handler)
+            : io_uring_operation(&pooled_receive_op::do_complete)
+            , socket_(s)
+            , pool_(pool)
+            , handler_(std::move(handler))
+            , done_(false)
+            , resume_posted_(false)
+            , finished_(false)
+        {
+        }
+
+        static void do_complete(void* owner, io_uring_operation* base, int result, unsigned flags)
+        {
+            pooled_receive_op* o = static_cast<pooled_receive_op*>(base);
+            if (owner == 0)
+            {
+                delete o;
+                return;
+            }
+
+            io_uring_io_context* ctx = static_cast<io_uring_io_context*>(owner);
+            const bool more = (flags & IORING_CQE_F_MORE) != 0;
+            if (!o->done_)
+            {
+                if (result >= 0)
+                {
+                    // A drain still in progress picks this data up.
+                    if (!o->resume_posted_)
+                        o->do_drain(ctx);
+                }
+                else if (!more)
+                {
+                    o->done_ = true;
+                    o->handler_(std::error_code(-result, std::generic_category()), mutablebuf());
+                }
+            }
+
+            if (!more)
+            {
+                if (!o->done_)
+                {
+                    ctx->start_poll(o->socket_, o);
+                    return;
+                }
+                ctx->work_finished();
+                if (o->resume_posted_)
+                {
+                    // The posted drain deletes the operation.
+                    o->finished_ = true;
+                    return;
+                }
+                ctx->unlink_operation(o);
+                delete o;
+            }
+            else if (o->done_)
+            {
+                // The handler has had its last call; the poll is still
+                // armed, so remove it and finish on its final completion.
+                ctx->cancel_operation(o);
+            }
+        }
+
+        // Drain the socket, and if it still has data after max_drain_blocks
+        // blocks, continue from a posted handler so that the other sockets
+        // are served in between. The poll only reports new arrivals, so it
+        // cannot be relied on to come back for the rest.
+        void do_drain(io_uring_io_context* ctx)
+        {
+            bool capped = false;
+            done_ = !drain(capped);
+            if (capped)
+            {
+                resume_posted_ = true;
+                ctx->post([ctx, this]() { resume(ctx); });
+            }
+        }
+
+        void resume(io_uring_io_context* ctx)
+        {
+            resume_posted_ = false;
+            if (finished_)
+            {
+                ctx->unlink_operation(this);
+                delete this;
+                return;
+            }
+            if (done_)
+                return;
+            do_drain(ctx);
+            if (done_)
+                ctx->cancel_operation(this);
+        }
+
+        // Receive until the socket would block, or until max_drain_blocks
+        // blocks have been filled, which sets capped. Returns false once the
+        // handler has had its last call.
+        bool drain(bool& capped)
+        {
+            for (int blocks = 0;;)
+            {
+                if (blocks == max_drain_blocks)
+                {
+                    capped = true;
+                    return true;
+                }
+                mutablebuf buffer = pool_.acquire();
+                socket_ops::buf b;
+                socket_ops::init_buf(b, buffer.data(), buffer.size());
+                std::error_code ec;
+                signed_size_type n = socket_ops::recv(socket_, &b, 1, MSG_DONTWAIT, ec);
+                if (n > 0)
+                {
+                    // Keep going even after a short read: the poll only
+                    // reports new arrivals, so a FIN queued behind this data
+                    // would otherwise never be seen.
+                    handler_(ec, mutablebuf(buffer, static_cast<std::size_t>(n)));
+                    ++blocks;
+                    continue;
+                }
+                if (n == 0)
+                {
+                    handler_(ec, mutablebuf());
+                    return false;
+                }
+                if (ec == std::errc::interrupted)
+                    continue;
+                if (ec == std::errc::operation_would_block
+                    || ec == std::errc::resource_unavailable_try_again)
+                    return true;
+                handler_(ec, mutablebuf());
+                return false;
+            }
+        }
+
+        socket_type socket_;
+        buffer_pool& pool_;
+        Handler handler_;
+        bool done_;
+
+        // Whether a drain is posted, and whether the poll has ended while
+        // it was.
+        bool resume_posted_;
+        bool finished_;
+    };
+
+    // A group of buffers shared with the kernel through a buffer ring.
+    struct buffer_group
+    {
+        io_uring_buf_ring* ring;
+        std::size_t ring_bytes;
+        unsigned ring_entries;
+        unsigned short tail;
+        char* buffers;
+        std::size_t buffers_bytes;
+        std::size_t buffer_size;
+    };
+
+    // The user_data of the eventfd poll that wakes the loop for post() and
+    // stop(). Operations are heap objects, so no operation has this address.
+    enum { wakeup_tag = 1 };
+
+    NETWORK_API io_uring_sqe* get_sqe();
+    NETWORK_API void start_accept(socket_type s, io_uring_operation* op);
+    NETWORK_API void start_receive(socket_type s, unsigned short buffer_group, io_uring_operation* op);
+    NETWORK_API void start_poll(socket_type s, io_uring_operation* op);
+    NETWORK_API void start_wakeup();
+    NETWORK_API void cancel_operation(io_uring_operation* op);
+
+    // Submit prepared entries and, if min_complete is non-zero, wait for
+    // completions.
+    NETWORK_API bool submit(unsigned min_complete, std::error_code& ec);
+
+    // Call the handlers of every completion in the queue.
+    NETWORK_API std::size_t reap(bool measure);
+
+    NETWORK_API std::size_t run_posted(bool measure);
+
+    // Send the data of every coalescer scheduled since the last call.
+    NETWORK_API void flush_scheduled();
+
+    // Spin until a completion arrives, the loop is stopped or the budget is
+    // spent. Returns true if there is something to do.
+    NETWORK_API bool spin(bool measure);
+
+    // Set the busy poll options on a socket being registered, if on.
+    void prepare_busy_poll(socket_type s)
+    {
+        if (busy_poll_)
+        {
+            std::error_code ignored_ec;
+            apply_busy_poll(s, ignored_ec);
+        }
+    }
+    NETWORK_API std::size_t do_one(bool block, std::error_code& ec);
+    NETWORK_API void wake();
+
+    char* buffer_data(unsigned short group, unsigned short buffer_id) const
+    {
+        const buffer_group& g = buffer_groups_[group];
+        return g.buffers + buffer_id * g.buffer_size;
+    }
+
+    NETWORK_API void recycle_buffer(unsigned short group, unsigned short buffer_id);
+
+    void link_operation(io_uring_operation* op)
+    {
+        op->prev_ = 0;
+        op->next_ = operations_;
+        if (operations_)
+            operations_->prev_ = op;
+        operations_ = op;
+    }
+
+    void unlink_operation(io_uring_operation* op)
+    {
+        if (op->prev_)
+            op->prev_->next_ = op->next_;
+        else
+            operations_ = op->next_;
+        if (op->next_)
+            op->next_->prev_ = op->prev_;
+        op->next_ = op->prev_ = 0;
+    }
+
+    void work_started()
+    {
+        outstanding_work_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void work_finished()
+    {
+        outstanding_work_.fetch_sub(1, std::memory_order_release);
+    }
+
+    // The ring descriptor and its shared memory.
+    int ring_fd_;
+    void* ring_ptr_;
+    std::size_t ring_bytes_;
+    io_uring_sqe* sqes_;
+    std::size_t sqes_bytes_;
+
+    // Submission queue.
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    unsigned sq_tail_local_;
+    unsigned sq_pending_;
+
+    // Completion queue.
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned cq_mask_;
+    io_uring_cqe* cqes_;
+
+    // The eventfd that wakes the loop.
+    int wakeup_fd_;
+    std::atomic<bool> wakeup_pending_;
+
+    // A handler passed to post(), with the time it was posted if metrics
+    // were on.
+    struct posted_handler
+    {
+        handler_type handler;
+        uint64_t posted_ns;
+    };
+
+    // Handlers passed to post().
+    std::mutex mutex_;
+    std::vector<posted_handler> posted_;
+    std::vector<posted_handler> running_;
+
+    // Operations and posted handlers that have not finished.
+    std::atomic<std::size_t> outstanding_work_;
+
+    std::atomic<bool> stopped_;
+
+    // Every operation the kernel still knows about.
+    io_uring_operation* operations_;
+
+    std::vector<buffer_group> buffer_groups_;
+
+    // Coalescers to flush at the end of the iteration. A cancelled entry is
+    // null.
+    std::vector<write_coalescer*> flush_list_;
+
+    std::atomic<bool> metrics_enabled_;
+    std::atomic<bool> metrics_reset_pending_;
+    loop_metrics metrics_;
+
+    // The busy poll mode, and whether the ring is registered for NAPI busy
+    // polling.
+    bool busy_poll_;
+    busy_poll_options busy_poll_options_;
+    bool napi_registered_;
+};
+
+} // namespace NetLite
+
+#include "NetLite/io_services/io_uring_io_context.ipp"
+
+#endif // defined(NETWORK_HAS_IO_URING)
+
+#endif // END OF NETLITE_IO_URING_IO_CONTEXT_HPP
@@ -0,0 +1,639 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_IO_URING_IO_CONTEXT_IPP
+#define NETLITE_IO_URING_IO_CONTEXT_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include "NetLite/io_services/io_uring_io_context.hpp"
+
+namespace NetLite{
+
+io_uring_io_context::io_uring_io_context(unsigned entries)
+    : ring_fd_(-1)
+    , ring_ptr_(MAP_FAILED)
+    , ring_bytes_(0)
+    , sqes_(0)
+    , sqes_bytes_(0)
+    , sq_head_(0)
+    , sq_tail_(0)
+    , sq_mask_(0)
+    , sq_entries_(0)
+    , sq_tail_local_(0)
+    , sq_pending_(0)
+    , cq_head_(0)
+    , cq_tail_(0)
+    , cq_mask_(0)
+    , cqes_(0)
+    , wakeup_fd_(-1)
+    , wakeup_pending_(false)
+    , outstanding_work_(0)
+    , stopped_(false)
+    , operations_(0)
+    , metrics_enabled_(false)
+    , metrics_reset_pending_(false)
+    , busy_poll_(false)
+    , napi_registered_(false)
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd_ < 0)
+    {
+        std::error_code ec(errno, std::generic_category());
+        throw_if(ec, "io_uring_setup");
+    }
+
+    // The submission and completion rings share one mapping on every kernel
+    // that has the multishot operations.
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0)
+    {
+        ::close(ring_fd_);
+        throw_if(std::make_error_code(std::errc::operation_not_supported), "io_uring_setup");
+    }
+
+    const std::size_t sq_bytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    const std::size_t cq_bytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    ring_bytes_ = sq_bytes > cq_bytes ? sq_bytes : cq_bytes;
+    ring_ptr_ = ::mmap(0, ring_bytes_, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ring_ptr_ == MAP_FAILED ? MAP_FAILED : ::mmap(0, sqes_bytes_,
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    wakeup_fd_ = sqes == MAP_FAILED ? -1 : ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ < 0)
+    {
+        std::error_code ec(errno, std::generic_category());
+        if (sqes != MAP_FAILED)
+            ::munmap(sqes, sqes_bytes_);
+        if (ring_ptr_ != MAP_FAILED)
+            ::munmap(ring_ptr_, ring_bytes_);
+        ::close(ring_fd_);
+        throw_if(ec, "io_uring_setup");
+    }
+
+    char* ring = static_cast<char*>(ring_ptr_);
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+    sq_head_ = reinterpret_cast<unsigned*>(ring + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    sq_tail_local_ = *sq_tail_;
+    cq_head_ = reinterpret_cast<unsigned*>(ring + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(ring + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(ring + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+
+    // Slot i of the submission array always names entry i, so only the tail
+    // has to be published when entries are submitted.
+    unsigned* sq_array = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+    for (unsigned i = 0; i < sq_entries_; ++i)
+        sq_array[i] = i;
+
+    start_wakeup();
+}
+
+io_uring_io_context::~io_uring_io_context()
+{
+    // Closing the ring cancels everything still in the kernel.
+    ::close(ring_fd_);
+    ::close(wakeup_fd_);
+    ::munmap(sqes_, sqes_bytes_);
+    ::munmap(ring_ptr_, ring_bytes_);
+
+    while (operations_)
+    {
+        io_uring_operation* op = operations_;
+        operations_ = op->next_;
+        op->destroy();
+    }
+
+    for (std::size_t i = 0; i < buffer_groups_.size(); ++i)
+    {
+        ::munmap(buffer_groups_[i].ring, buffer_groups_[i].ring_bytes);
+        ::munmap(buffer_groups_[i].buffers, buffer_groups_[i].buffers_bytes);
+    }
+}
+
+unsigned short io_uring_io_context::add_buffer_group(std::size_t buffer_count,
+    std::size_t buffer_size, std::error_code& ec)
+{
+    ec = std::error_code();
+    if (buffer_count == 0 || buffer_count > 32768 || buffer_size == 0
+        || buffer_size > 0xffffffffu || buffer_groups_.size() > 0xffff)
+    {
+        ec = std::make_error_code(std::errc::invalid_argument);
+        return 0;
+    }
+
+    // The ring size must be a power of two.
+    unsigned ring_entries = 1;
+    while (ring_entries < buffer_count)
+        ring_entries <<= 1;
+
+    buffer_group g;
+    g.ring_entries = ring_entries;
+    g.tail = 0;
+    g.buffer_size = buffer_size;
+    g.ring_bytes = ring_entries * sizeof(io_uring_buf);
+    g.buffers_bytes = buffer_count * buffer_size;
+
+    // Both mappings are anonymous, so buffer pages are only backed once the
+    // kernel first writes into them.
+    void* ring = ::mmap(0, g.ring_bytes, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED)
+    {
+        ec = std::error_code(errno, std::generic_category());
+        return 0;
+    }
+    void* buffers = ::mmap(0, g.buffers_bytes, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffers == MAP_FAILED)
+    {
+        ec = std::error_code(errno, std::generic_category());
+        ::munmap(ring, g.ring_bytes);
+        return 0;
+    }
+    g.ring = static_cast<io_uring_buf_ring*>(ring);
+    g.buffers = static_cast<char*>(buffers);
+
+    const unsigned short group = static_cast<unsigned short>(buffer_groups_.size());
+    io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uintptr_t>(ring);
+    reg.ring_entries = ring_entries;
+    reg.bgid = group;
+    if (::syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        ec = std::error_code(errno, std::generic_category());
+        ::munmap(buffers, g.buffers_bytes);
+        ::munmap(ring, g.ring_bytes);
+        return 0;
+    }
+
+    buffer_groups_.push_back(g);
+    for (std::size_t i = 0; i < buffer_count; ++i)
+        recycle_buffer(group, static_cast<unsigned short>(i));
+    return group;
+}
+
+void io_uring_io_context::recycle_buffer(unsigned short group, unsigned short buffer_id)
+{
+    // Index the entries by hand: in C++ the flexible bufs member of
+    // io_uring_buf_ring does not start at offset zero.
+    buffer_group& g = buffer_groups_[group];
+    io_uring_buf& buf = reinterpret_cast<io_uring_buf*>(g.ring)[g.tail & (g.ring_entries - 1)];
+    buf.addr = reinterpret_cast<uintptr_t>(g.buffers + buffer_id * g.buffer_size);
+    buf.len = static_cast<uint32_t>(g.buffer_size);
+    buf.bid = buffer_id;
+    ++g.tail;
+    __atomic_store_n(&g.ring->tail, g.tail, __ATOMIC_RELEASE);
+}
+
+void io_uring_io_context::cancel(socket_type native_socket)
+{
+    io_uring_sqe* sqe = get_sqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = native_socket;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    sqe->user_data = 0;
+}
+
+void io_uring_io_context::post(handler_type handler)
+{
+    posted_handler posted;
+    posted.handler = std::move(handler);
+    posted.posted_ns = metrics_enabled() ? loop_metrics::now_ns() : 0;
+    work_started();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        posted_.push_back(std::move(posted));
+    }
+    wake();
+}
+
+void io_uring_io_context::stop()
+{
+    stopped_.store(true, std::memory_order_release);
+    wake();
+}
+
+void io_uring_io_context::wake()
+{
+    if (!wakeup_pending_.exchange(true, std::memory_order_acq_rel))
+    {
+        uint64_t counter = 1;
+        ssize_t ignored = ::write(wakeup_fd_, &counter, sizeof(counter));
+        (void)ignored;
+    }
+}
+
+std::size_t io_uring_io_context::run(std::error_code& ec)
+{
+    ec = std::error_code();
+    std::size_t n = 0;
+    while (!stopped() && outstanding_work_.load(std::memory_order_acquire) != 0)
+    {
+        n += do_one(true, ec);
+        if (ec)
+            break;
+    }
+    return n;
+}
+
+std::size_t io_uring_io_context::run_one(std::error_code& ec)
+{
+    ec = std::error_code();
+    std::size_t n = 0;
+    while (n == 0 && !stopped() && outstanding_work_.load(std::memory_order_acquire) != 0)
+    {
+        n = do_one(true, ec);
+        if (ec)
+            break;
+    }
+    return n;
+}
+
+std::size_t io_uring_io_context::poll(std::error_code& ec)
+{
+    ec = std::error_code();
+    std::size_t total = 0;
+    while (!stopped())
+    {
+        std::size_t n = do_one(false, ec);
+        if (ec || n == 0)
+            break;
+        total += n;
+    }
+    return total;
+}
+
+std::size_t io_uring_io_context::do_one(bool block, std::error_code& ec)
+{
+    // Sends staged outside the loop go out before it can sleep.
+    flush_scheduled();
+
+    // Only this thread records, so only it may clear the metrics.
+    if (metrics_reset_pending_.load(std::memory_order_relaxed)
+        && metrics_reset_pending_.exchange(false, std::memory_order_acq_rel))
+        metrics_.reset();
+
+    const bool measure = metrics_enabled();
+    std::size_t n = run_posted(measure);
+
+    // Only sleep when nothing has run and the completion queue is empty.
+    unsigned min_complete = 0;
+    if (block && n == 0 && !stopped()
+        && *cq_head_ == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE))
+        min_complete = 1;
+
+    // Spin before sleeping. The pending entries go in first, or nothing
+    // could complete while spinning.
+    if (min_complete && busy_poll_ && busy_poll_options_.spin_usec != 0)
+    {
+        if (!submit(0, ec))
+            return n;
+        if (spin(measure))
+            min_complete = 0;
+    }
+
+    const uint64_t wait_start = measure && min_complete ? loop_metrics::now_ns() : 0;
+    const bool submitted = submit(min_complete, ec);
+    if (wait_start)
+        metrics_.record_wait(loop_metrics::now_ns() - wait_start);
+    if (submitted)
+        n += reap(measure);
+    flush_scheduled();
+    if (measure)
+        metrics_.record_iteration(n);
+    return n;
+}
+
+bool io_uring_io_context::spin(bool measure)
+{
+    const uint64_t start = loop_metrics::now_ns();
+    const uint64_t budget = static_cast<uint64_t>(busy_poll_options_.spin_usec) * 1000;
+    uint64_t now = start;
+    bool found = false;
+    for (;;)
+    {
+        // A post() or stop() completes the eventfd poll, so the completion
+        // queue is the only thing to watch.
+        if (*cq_head_ != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE) || stopped())
+        {
+            found = true;
+            now = loop_metrics::now_ns();
+            break;
+        }
+        now = loop_metrics::now_ns();
+        if (now - start >= budget)
+            break;
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        __asm__ __volatile__("yield");
+#endif // defined(__x86_64__) || defined(__i386__)
+    }
+    if (measure)
+        metrics_.record_spin(now - start, found);
+    return found;
+}
+
+namespace io_uring_detail{
+
+// IORING_REGISTER_NAPI and IORING_UNREGISTER_NAPI of Linux 6.9, which older
+// headers lack. Older kernels reject them with EINVAL.
+enum { register_napi = 27, unregister_napi = 28 };
+
+struct napi_registration
+{
+    uint32_t busy_poll_to;
+    uint8_t prefer_busy_poll;
+    uint8_t pad[3];
+    uint64_t resv;
+};
+
+} // namespace io_uring_detail
+
+void io_uring_io_context::enable_busy_poll(const busy_poll_options& options)
+{
+    busy_poll_ = true;
+    busy_poll_options_ = options;
+
+    io_uring_detail::napi_registration napi;
+    std::memset(&napi, 0, sizeof(napi));
+    if (options.socket_usec != 0)
+    {
+        napi.busy_poll_to = options.socket_usec;
+        napi.prefer_busy_poll = options.prefer ? 1 : 0;
+        napi_registered_ = ::syscall(__NR_io_uring_register, ring_fd_,
+            io_uring_detail::register_napi, &napi, 1) == 0;
+    }
+    else if (napi_registered_)
+    {
+        ::syscall(__NR_io_uring_register, ring_fd_, io_uring_detail::unregister_napi, &napi, 1);
+        napi_registered_ = false;
+    }
+}
+
+void io_uring_io_context::disable_busy_poll()
+{
+    busy_poll_ = false;
+    if (napi_registered_)
+    {
+        io_uring_detail::napi_registration napi;
+        std::memset(&napi, 0, sizeof(napi));
+        ::syscall(__NR_io_uring_register, ring_fd_, io_uring_detail::unregister_napi, &napi, 1);
+        napi_registered_ = false;
+    }
+}
+
+std::error_code io_uring_io_context::apply_busy_poll(socket_type native_socket, std::error_code& ec)
+{
+    ec = std::error_code();
+    if (!busy_poll_)
+        return ec;
+
+    socket_ops::state_type state = 0;
+    const busy_poll_options& o = busy_poll_options_;
+    if (o.socket_usec != 0)
+    {
+        int value = static_cast<int>(o.socket_usec);
+        socket_ops::setsockopt(native_socket, state, SOL_SOCKET, SO_BUSY_POLL,
+            &value, sizeof(value), ec);
+        if (ec)
+            return ec;
+#if defined(SO_PREFER_BUSY_POLL)
+        if (o.prefer)
+        {
+            value = 1;
+            socket_ops::setsockopt(native_socket, state, SOL_SOCKET, SO_PREFER_BUSY_POLL,
+                &value, sizeof(value), ec);
+            if (ec)
+                return ec;
+        }
+#endif // defined(SO_PREFER_BUSY_POLL)
+    }
+#if defined(SO_BUSY_POLL_BUDGET)
+    if (o.budget != 0)
+    {
+        int value = static_cast<int>(o.budget);
+        socket_ops::setsockopt(native_socket, state, SOL_SOCKET, SO_BUSY_POLL_BUDGET,
+            &value, sizeof(value), ec);
+    }
+#endif // defined(SO_BUSY_POLL_BUDGET)
+    return ec;
+}
+
+void io_uring_io_context::schedule_flush(write_coalescer* coalescer)
+{
+    flush_list_.push_back(coalescer);
+}
+
+void io_uring_io_context::cancel_flush(write_coalescer* coalescer)
+{
+    std::replace(flush_list_.begin(), flush_list_.end(), coalescer, static_cast<write_coalescer*>(0));
+}
+
+void io_uring_io_context::flush_scheduled()
+{
+    // Flushing calls no handlers, so the list cannot change underneath.
+    for (std::size_t i = 0; i < flush_list_.size(); ++i)
+    {
+        if (flush_list_[i])
+            flush_list_[i]->scheduled_flush();
+    }
+    flush_list_.clear();
+}
+
+std::size_t io_uring_io_context::run_posted(bool measure)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (posted_.empty())
+            return 0;
+        running_.swap(posted_);
+    }
+
+    // Each handler ends where the next begins, so timing costs one clock
+    // read per handler.
+    uint64_t start = measure ? loop_metrics::now_ns() : 0;
+    const std::size_t n = running_.size();
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        handler_type handler(std::move(running_[i].handler));
+        if (measure && running_[i].posted_ns != 0)
+            metrics_.record_post_lag(start - running_[i].posted_ns);
+        handler();
+        work_finished();
+        if (measure)
+        {
+            const uint64_t end = loop_metrics::now_ns();
+            metrics_.record_handler(end - start);
+            start = end;
+        }
+    }
+    running_.clear();
+    return n;
+}
+
+bool io_uring_io_context::submit(unsigned min_complete, std::error_code& ec)
+{
+    if (sq_pending_ == 0 && min_complete == 0)
+        return true;
+
+    // Publish the entries prepared since the last call.
+    __atomic_store_n(sq_tail_, sq_tail_local_, __ATOMIC_RELEASE);
+
+    for (;;)
+    {
+        const int result = static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd_,
+            sq_pending_, min_complete, min_complete ? IORING_ENTER_GETEVENTS : 0, 0, 0));
+        if (result >= 0)
+        {
+            sq_pending_ -= static_cast<unsigned>(result);
+            return true;
+        }
+        // A signal, or a completion queue that is full: either way the
+        // caller reaps what is there and comes back.
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+            return true;
+        ec = std::error_code(errno, std::generic_category());
+        return false;
+    }
+}
+
+std::size_t io_uring_io_context::reap(bool measure)
+{
+    std::size_t n = 0;
+    uint64_t start = measure ? loop_metrics::now_ns() : 0;
+    unsigned head = *cq_head_;
+    for (;;)
+    {
+        if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE))
+            break;
+
+        // Copy the entry and hand the slot back before calling the handler,
+        // which may submit more work.
+        const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+        const uint64_t user_data = cqe.user_data;
+        const int result = cqe.res;
+        const unsigned flags = cqe.flags;
+        ++head;
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+        if (user_data == 0)
+            continue;
+        if (user_data == wakeup_tag)
+        {
+            uint64_t counter = 0;
+            ssize_t ignored = ::read(wakeup_fd_, &counter, sizeof(counter));
+            (void)ignored;
+            wakeup_pending_.store(false, std::memory_order_release);
+            if ((flags & IORING_CQE_F_MORE) == 0)
+                start_wakeup();
+            // Keep the eventfd read out of the next handler's time.
+            if (measure)
+                start = loop_metrics::now_ns();
+            continue;
+        }
+
+        reinterpret_cast<io_uring_operation*>(user_data)->complete(this, result, flags);
+        ++n;
+        if (measure)
+        {
+            const uint64_t end = loop_metrics::now_ns();
+            metrics_.record_handler(end - start);
+            start = end;
+        }
+    }
+    return n;
+}
+
+io_uring_sqe* io_uring_io_context::get_sqe()
+{
+    if (sq_tail_local_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_)
+    {
+        // The queue is full. Without SQPOLL the kernel consumes every entry
+        // it is given during the call, so this always makes room.
+        std::error_code ec;
+        submit(0, ec);
+        throw_if(ec, "io_uring_enter");
+    }
+
+    io_uring_sqe* sqe = &sqes_[sq_tail_local_ & sq_mask_];
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+    ++sq_tail_local_;
+    ++sq_pending_;
+    return sqe;
+}
+
+void io_uring_io_context::start_accept(socket_type s, io_uring_operation* op)
+{
+    io_uring_sqe* sqe = get_sqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = s;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = reinterpret_cast<uintptr_t>(op);
+}
+
+void io_uring_io_context::start_receive(socket_type s, unsigned short buffer_group, io_uring_operation* op)
+{
+    io_uring_sqe* sqe = get_sqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = s;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = buffer_group;
+    sqe->user_data = reinterpret_cast<uintptr_t>(op);
+}
+
+void io_uring_io_context::start_poll(socket_type s, io_uring_operation* op)
+{
+    io_uring_sqe* sqe = get_sqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = s;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = reinterpret_cast<uintptr_t>(op);
+}
+
+void io_uring_io_context::cancel_operation(io_uring_operation* op)
+{
+    io_uring_sqe* sqe = get_sqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = reinterpret_cast<uintptr_t>(op);
+    sqe->user_data = 0;
+}
+
+void io_uring_io_context::start_wakeup()
+{
+    io_uring_sqe* sqe = get_sqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = wakeup_fd_;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = wakeup_tag;
+}
+
+} // namespace NetLite
+
+#endif // END OF NETLITE_IO_URING_IO_CONTEXT_IPP
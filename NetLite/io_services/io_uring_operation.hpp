@@ -0,0 +1,72 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_IO_URING_OPERATION_HPP
+#define NETLITE_IO_URING_OPERATION_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "NetLite/config.hpp"
+
+#if defined(NETWORK_HAS_IO_URING)
+
+namespace NetLite{
+
+/**
+ * Base class for operations submitted to an io_uring_io_context.
+ *
+ * The address of the operation is the user_data of its submission queue
+ * entries, so one multishot operation receives every completion the kernel
+ * produces for it. The context owns the operation from submission until the
+ * kernel reports that no more completions will follow.
+ */
+class io_uring_operation
+{
+public:
+    /// Completion function. A null owner asks the operation to destroy itself
+    /// without calling its handler.
+    typedef void(*func_type)(void* owner, io_uring_operation* op, int result, unsigned flags);
+
+    void complete(void* owner, int result, unsigned flags)
+    {
+        func_(owner, this, result, flags);
+    }
+
+    void destroy()
+    {
+        func_(0, this, 0, 0);
+    }
+
+protected:
+    explicit io_uring_operation(func_type func)
+        : func_(func)
+        , next_(0)
+        , prev_(0)
+    {
+    }
+
+    // Prevents deletion through this type.
+    ~io_uring_operation()
+    {
+    }
+
+private:
+    friend class io_uring_io_context;
+
+    func_type func_;
+
+    // Links in the context's list of live operations.
+    io_uring_operation* next_;
+    io_uring_operation* prev_;
+};
+
+} // namespace NetLite
+
+#endif // defined(NETWORK_HAS_IO_URING)
+
+#endif // END OF NETLITE_IO_URING_OPERATION_HPP
@@ -0,0 +1,356 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_LOOP_METRICS_HPP
+#define NETLITE_LOOP_METRICS_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "NetLite/config.hpp"
+
+#if defined(_MSC_VER)
+# include <intrin.h>
+#endif // defined(_MSC_VER)
+
+namespace NetLite{
+
+/**
+ * A histogram of 64-bit values in logarithmic buckets.
+ *
+ * Values below 4 have a bucket each; above that every power of two is split
+ * into 4 buckets, so a bucket is never wider than a quarter of its lower
+ * bound. The whole range of uint64_t fits in 252 counters.
+ *
+ * record() must only be called by one thread at a time, which lets it update
+ * the counters with plain relaxed stores instead of read-modify-write
+ * instructions. load() may be called from any thread at any time; a load
+ * that races with record() sees each counter either before or after the
+ * update. reset() must not race with record(): a reset landing between the
+ * load and the store of an update would be overwritten. Call it from the
+ * recording thread, or while nothing records.
+ */
+class log_histogram
+{
+public:
+    enum { sub_bucket_bits = 2, sub_buckets = 1 << sub_bucket_bits };
+    enum { bucket_count = sub_buckets + (64 - sub_bucket_bits) * sub_buckets };
+
+    /// A copy of the histogram at one point in time.
+    struct snapshot
+    {
+        uint64_t count;
+        uint64_t sum;
+        uint64_t max;
+        uint64_t buckets[bucket_count];
+
+        double mean() const
+        {
+            return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0;
+        }
+
+        /**
+         * Get the value below which the given percentage of the recorded
+         * values fall. The result is the upper bound of the bucket holding
+         * that value, so it overstates by at most a quarter, and is never
+         * larger than max.
+         *
+         * @param p A percentage from 0 to 100.
+         */
+        uint64_t percentile(double p) const
+        {
+            if (count == 0)
+                return 0;
+            uint64_t rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(count) + 0.5);
+            if (rank == 0)
+                rank = 1;
+            uint64_t seen = 0;
+            for (std::size_t i = 0; i < bucket_count; ++i)
+            {
+                seen += buckets[i];
+                if (seen >= rank)
+                {
+                    uint64_t upper = bucket_upper(i);
+                    return upper < max ? upper : max;
+                }
+            }
+            return max;
+        }
+    };
+
+    log_histogram() noexcept
+    {
+        reset();
+    }
+
+    log_histogram(const log_histogram&) = delete;
+    log_histogram& operator=(const log_histogram&) = delete;
+
+    /// Add a value. Only one thread may record at a time.
+    void record(uint64_t value) noexcept
+    {
+        bump(buckets_[bucket_index(value)], 1);
+        bump(count_, 1);
+        bump(sum_, value);
+        if (value > max_.load(std::memory_order_relaxed))
+            max_.store(value, std::memory_order_relaxed);
+    }
+
+    /// Read all counters.
+    snapshot load() const noexcept
+    {
+        snapshot s;
+        s.count = count_.load(std::memory_order_relaxed);
+        s.sum = sum_.load(std::memory_order_relaxed);
+        s.max = max_.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < bucket_count; ++i)
+            s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        return s;
+    }
+
+    /// Set all counters to zero. Must not race with record().
+    void reset() noexcept
+    {
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < bucket_count; ++i)
+            buckets_[i].store(0, std::memory_order_relaxed);
+    }
+
+    static std::size_t bucket_index(uint64_t value) noexcept
+    {
+        if (value < sub_buckets)
+            return static_cast<std::size_t>(value);
+        const unsigned shift = highest_bit(value) - sub_bucket_bits;
+        return static_cast<std::size_t>(sub_buckets + shift * sub_buckets
+            + ((value >> shift) & (sub_buckets - 1)));
+    }
+
+    /// The largest value that falls into a bucket.
+    static uint64_t bucket_upper(std::size_t index) noexcept
+    {
+        if (index < sub_buckets)
+            return index;
+        const unsigned shift = static_cast<unsigned>((index - sub_buckets) / sub_buckets);
+        const uint64_t lower = static_cast<uint64_t>(sub_buckets + (index - sub_buckets) % sub_buckets) << shift;
+        return lower + ((uint64_t(1) << shift) - 1);
+    }
+
+private:
+    // The index of the highest set bit of a non-zero value.
+    static unsigned highest_bit(uint64_t value) noexcept
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<unsigned>(index);
+#else // defined(_MSC_VER)
+        return static_cast<unsigned>(63 - __builtin_clzll(value));
+#endif // defined(_MSC_VER)
+    }
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t n) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+    std::atomic<uint64_t> buckets_[bucket_count];
+};
+
+/**
+ * Metrics of an io_context run loop.
+ *
+ * The loop thread records into these while metrics are enabled; any thread
+ * may pull a snapshot. One loop iteration is one pass of the context's
+ * do_one(): run the posted handlers, spin and then wait in the kernel if
+ * there is nothing to do, then call the handlers of every completion that
+ * arrived.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Safe for load(); the record functions and reset()
+ * must only be called from the thread running the loop, or while it is not
+ * recording.
+ */
+class loop_metrics
+{
+public:
+    /// The number of slowest handler durations kept.
+    enum { slowest_kept = 8 };
+
+    /// A copy of the metrics at one point in time. All times are in
+    /// nanoseconds.
+    struct snapshot
+    {
+        /// Loop iterations.
+        uint64_t iterations;
+
+        /// Handlers called, posted or completion.
+        uint64_t handlers;
+
+        /// Total time spent blocked in the kernel waiting for completions.
+        uint64_t wait_ns;
+
+        /// Total time spent in handlers.
+        uint64_t handler_ns;
+
+        /// Spins before a wait, those that ended because work arrived, and
+        /// the total time spent spinning. All zero unless busy polling.
+        uint64_t spins;
+        uint64_t spin_hits;
+        uint64_t spin_ns;
+
+        /// Handlers called per loop iteration.
+        log_histogram::snapshot events_per_iteration;
+
+        /// Duration of each wait in the kernel.
+        log_histogram::snapshot wait_time;
+
+        /// Duration of each handler.
+        log_histogram::snapshot handler_time;
+
+        /// Time from post() until the posted handler started to run.
+        log_histogram::snapshot post_lag;
+
+        /// The longest handler durations, longest first; unused slots are 0.
+        uint64_t slowest_handlers[slowest_kept];
+    };
+
+    loop_metrics() noexcept
+    {
+        reset();
+    }
+
+    loop_metrics(const loop_metrics&) = delete;
+    loop_metrics& operator=(const loop_metrics&) = delete;
+
+    /// Count a loop iteration that called the given number of handlers.
+    void record_iteration(std::size_t handlers) noexcept
+    {
+        bump(iterations_, 1);
+        events_per_iteration_.record(handlers);
+    }
+
+    /// Count a wait in the kernel.
+    void record_wait(uint64_t ns) noexcept
+    {
+        bump(wait_ns_, ns);
+        wait_time_.record(ns);
+    }
+
+    /// Count a spin that found work or ran out of budget.
+    void record_spin(uint64_t ns, bool found) noexcept
+    {
+        bump(spins_, 1);
+        if (found)
+            bump(spin_hits_, 1);
+        bump(spin_ns_, ns);
+    }
+
+    /// Count a handler call.
+    void record_handler(uint64_t ns) noexcept
+    {
+        bump(handlers_, 1);
+        bump(handler_ns_, ns);
+        handler_time_.record(ns);
+
+        // Kept sorted longest first, so the common case is one compare.
+        if (ns <= slowest_[slowest_kept - 1].load(std::memory_order_relaxed))
+            return;
+        std::size_t i = slowest_kept - 1;
+        for (; i > 0; --i)
+        {
+            const uint64_t above = slowest_[i - 1].load(std::memory_order_relaxed);
+            if (above >= ns)
+                break;
+            slowest_[i].store(above, std::memory_order_relaxed);
+        }
+        slowest_[i].store(ns, std::memory_order_relaxed);
+    }
+
+    /// Count the delay between posting a handler and running it.
+    void record_post_lag(uint64_t ns) noexcept
+    {
+        post_lag_.record(ns);
+    }
+
+    /// Read all metrics.
+    snapshot load() const noexcept
+    {
+        snapshot s;
+        s.iterations = iterations_.load(std::memory_order_relaxed);
+        s.handlers = handlers_.load(std::memory_order_relaxed);
+        s.wait_ns = wait_ns_.load(std::memory_order_relaxed);
+        s.handler_ns = handler_ns_.load(std::memory_order_relaxed);
+        s.spins = spins_.load(std::memory_order_relaxed);
+        s.spin_hits = spin_hits_.load(std::memory_order_relaxed);
+        s.spin_ns = spin_ns_.load(std::memory_order_relaxed);
+        s.events_per_iteration = events_per_iteration_.load();
+        s.wait_time = wait_time_.load();
+        s.handler_time = handler_time_.load();
+        s.post_lag = post_lag_.load();
+        for (std::size_t i = 0; i < slowest_kept; ++i)
+            s.slowest_handlers[i] = slowest_[i].load(std::memory_order_relaxed);
+        return s;
+    }
+
+    /// Set all metrics to zero. Must not race with the record functions.
+    void reset() noexcept
+    {
+        iterations_.store(0, std::memory_order_relaxed);
+        handlers_.store(0, std::memory_order_relaxed);
+        wait_ns_.store(0, std::memory_order_relaxed);
+        handler_ns_.store(0, std::memory_order_relaxed);
+        spins_.store(0, std::memory_order_relaxed);
+        spin_hits_.store(0, std::memory_order_relaxed);
+        spin_ns_.store(0, std::memory_order_relaxed);
+        events_per_iteration_.reset();
+        wait_time_.reset();
+        handler_time_.reset();
+        post_lag_.reset();
+        for (std::size_t i = 0; i < slowest_kept; ++i)
+            slowest_[i].store(0, std::memory_order_relaxed);
+    }
+
+    /// The clock the loop is timed with, in nanoseconds.
+    static uint64_t now_ns() noexcept
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& counter, uint64_t n) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> iterations_;
+    std::atomic<uint64_t> handlers_;
+    std::atomic<uint64_t> wait_ns_;
+    std::atomic<uint64_t> handler_ns_;
+    std::atomic<uint64_t> spins_;
+    std::atomic<uint64_t> spin_hits_;
+    std::atomic<uint64_t> spin_ns_;
+    log_histogram events_per_iteration_;
+    log_histogram wait_time_;
+    log_histogram handler_time_;
+    log_histogram post_lag_;
+    std::atomic<uint64_t> slowest_[slowest_kept];
+};
+
+} // namespace NetLite
+
+#endif // END OF NETLITE_LOOP_METRICS_HPP
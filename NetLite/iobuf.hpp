@@ -0,0 +1,185 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_IOBUF_HPP
+#define NETLITE_IOBUF_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstddef>
+#include <list>
+#include <utility>
+#include "NetLite/config.hpp"
+#include "NetLite/mutablebuf.hpp"
+
+namespace NetLite{
+
+/**
+ * A chain of buffer slices for zero-copy pipelines.
+ *
+ * Each slice is a mutablebuf that shares ownership of its backing block, so
+ * copying an iobuf, or splitting it, never copies payload bytes: a frame
+ * received once can be handed to any number of consumers, and the block is
+ * released when the last slice referring to it is gone.
+ *
+ * Appending or prepending a slice or a whole chain is O(1). Splitting and
+ * trimming walk only the slices they remove, and cut at most one slice in
+ * two.
+ *
+ * An iobuf is a buffer sequence: begin() and end() iterate over its slices,
+ * so it can be passed to basic_socket::send() and receive(), or to
+ * buffer_sequence_adapter to build an iovec array.
+ *
+ * @par Example
+ * @code
+ * NetLite::iobuf frame = inbound.split(frame_length);
+ * for (auto& subscriber : subscribers)
+ *     subscriber.socket.send(frame);
+ * @endcode
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+class iobuf
+{
+public:
+    /// The type of an iterator over the slices.
+    typedef std::list<mutablebuf>::const_iterator const_iterator;
+
+    /// Construct an empty chain.
+    iobuf()
+        : size_(0)
+    {
+    }
+
+    /// Construct a chain of one slice.
+    explicit iobuf(const mutablebuf& slice)
+        : size_(0)
+    {
+        append(slice);
+    }
+
+    /// Copy a chain. The slices share the other chain's blocks.
+    iobuf(const iobuf& other)
+        : slices_(other.slices_)
+        , size_(other.size_)
+    {
+    }
+
+    /// Move a chain, leaving the other one empty.
+    iobuf(iobuf&& other)
+        : slices_(std::move(other.slices_))
+        , size_(other.size_)
+    {
+        other.slices_.clear();
+        other.size_ = 0;
+    }
+
+    /// Copy-assign a chain. The slices share the other chain's blocks.
+    iobuf& operator=(const iobuf& other)
+    {
+        slices_ = other.slices_;
+        size_ = other.size_;
+        return *this;
+    }
+
+    /// Move-assign a chain, leaving the other one empty.
+    iobuf& operator=(iobuf&& other)
+    {
+        slices_ = std::move(other.slices_);
+        size_ = other.size_;
+        other.slices_.clear();
+        other.size_ = 0;
+        return *this;
+    }
+
+    /// Get an iterator to the first slice.
+    const_iterator begin() const
+    {
+        return slices_.begin();
+    }
+
+    /// Get an iterator past the last slice.
+    const_iterator end() const
+    {
+        return slices_.end();
+    }
+
+    /// Get the number of bytes in the chain.
+    std::size_t size() const
+    {
+        return size_;
+    }
+
+    /// Determine whether the chain holds no bytes.
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    /// Get the number of slices.
+    std::size_t slice_count() const
+    {
+        return slices_.size();
+    }
+
+    /// Add a slice at the end. Empty slices are ignored.
+    NETWORK_API void append(const mutablebuf& slice);
+
+    /// Move all slices of another chain to the end, leaving it empty.
+    NETWORK_API void append(iobuf&& other);
+
+    /// Add the slices of another chain at the end, sharing its blocks.
+    NETWORK_API void append(const iobuf& other);
+
+    /// Add a slice at the front. Empty slices are ignored.
+    NETWORK_API void prepend(const mutablebuf& slice);
+
+    /// Move all slices of another chain to the front, leaving it empty.
+    NETWORK_API void prepend(iobuf&& other);
+
+    /**
+     * Remove the first bytes of the chain and return them as a new chain.
+     * A slice that straddles the cut is shared by both chains.
+     *
+     * @param length The number of bytes to remove. At most size() bytes are
+     * removed.
+     */
+    NETWORK_API iobuf split(std::size_t length);
+
+    /// Drop up to length bytes from the front.
+    NETWORK_API void trim_front(std::size_t length);
+
+    /// Drop up to length bytes from the back.
+    NETWORK_API void trim_back(std::size_t length);
+
+    /**
+     * Copy bytes from the front of the chain into contiguous memory, without
+     * removing them.
+     * @returns The number of bytes copied, at most size().
+     */
+    NETWORK_API std::size_t copy_to(void* data, std::size_t length) const;
+
+    /// Drop every slice.
+    void clear()
+    {
+        slices_.clear();
+        size_ = 0;
+    }
+
+private:
+    std::list<mutablebuf> slices_;
+    std::size_t size_;
+};
+
+} // namespace NetLite
+
+#include "NetLite/iobuf.ipp"
+
+#endif // END OF NETLITE_IOBUF_HPP
@@ -0,0 +1,133 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_IOBUF_IPP
+#define NETLITE_IOBUF_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstring>
+#include "NetLite/iobuf.hpp"
+
+namespace NetLite{
+
+void iobuf::append(const mutablebuf& slice)
+{
+    if (slice.size() == 0)
+        return;
+    slices_.push_back(slice);
+    size_ += slice.size();
+}
+
+void iobuf::append(iobuf&& other)
+{
+    slices_.splice(slices_.end(), other.slices_);
+    size_ += other.size_;
+    other.size_ = 0;
+}
+
+void iobuf::append(const iobuf& other)
+{
+    slices_.insert(slices_.end(), other.slices_.begin(), other.slices_.end());
+    size_ += other.size_;
+}
+
+void iobuf::prepend(const mutablebuf& slice)
+{
+    if (slice.size() == 0)
+        return;
+    slices_.push_front(slice);
+    size_ += slice.size();
+}
+
+void iobuf::prepend(iobuf&& other)
+{
+    slices_.splice(slices_.begin(), other.slices_);
+    size_ += other.size_;
+    other.size_ = 0;
+}
+
+iobuf iobuf::split(std::size_t length)
+{
+    iobuf head;
+    while (length > 0 && !slices_.empty())
+    {
+        mutablebuf& front = slices_.front();
+        const std::size_t front_size = front.size();
+        if (length < front_size)
+        {
+            // Cut the slice: both halves keep the block alive.
+            head.slices_.push_back(mutablebuf(front, 0, length));
+            front = mutablebuf(front, length, front_size - length);
+            head.size_ += length;
+            size_ -= length;
+            break;
+        }
+        head.slices_.splice(head.slices_.end(), slices_, slices_.begin());
+        head.size_ += front_size;
+        size_ -= front_size;
+        length -= front_size;
+    }
+    return head;
+}
+
+void iobuf::trim_front(std::size_t length)
+{
+    while (length > 0 && !slices_.empty())
+    {
+        mutablebuf& front = slices_.front();
+        const std::size_t front_size = front.size();
+        if (length < front_size)
+        {
+            front = mutablebuf(front, length, front_size - length);
+            size_ -= length;
+            break;
+        }
+        slices_.pop_front();
+        size_ -= front_size;
+        length -= front_size;
+    }
+}
+
+void iobuf::trim_back(std::size_t length)
+{
+    while (length > 0 && !slices_.empty())
+    {
+        mutablebuf& back = slices_.back();
+        const std::size_t back_size = back.size();
+        if (length < back_size)
+        {
+            back = mutablebuf(back, back_size - length);
+            size_ -= length;
+            break;
+        }
+        slices_.pop_back();
+        size_ -= back_size;
+        length -= back_size;
+    }
+}
+
+std::size_t iobuf::copy_to(void* data, std::size_t length) const
+{
+    using namespace std; // For memcpy.
+    char* out = static_cast<char*>(data);
+    std::size_t copied = 0;
+    for (const_iterator iter = slices_.begin(); iter != slices_.end() && copied < length; ++iter)
+    {
+        std::size_t n = iter->size();
+        if (n > length - copied)
+            n = length - copied;
+        memcpy(out + copied, iter->data(), n);
+        copied += n;
+    }
+    return copied;
+}
+
+} // namespace NetLite
+
+#endif // END OF NETLITE_IOBUF_IPP
@@ -6,6 +6,7 @@
 #include <iosfwd>
 #include "NetLite/config.hpp"
 #include "NetLite/net_error_code.hpp"
+#include "NetLite/detail/hash.hpp"
 #include "NetLite/ip/address_v4.hpp"
 #include "NetLite/ip/address_v6.hpp"
 #include "NetLite/ip/bad_address_cast.hpp"
@@ -75,6 +76,14 @@ public:
     /// (Deprecated: Use other overload.) Get the address as a string.
     NETWORK_API std::string to_string(std::error_code& ec) const;
 
+    /**
+     * Write the address as IPv4 or IPv6 text to [first, last) without allocating.
+     * No null terminator is written.
+     * @returns One past the last character written, or a null pointer if the
+     * range is too small.
+     */
+    NETWORK_API char* to_chars(char* first, char* last) const;
+
     /// (Deprecated: Use make_address().) Create an address from an IPv4 address
     /// string in dotted decimal form, or from an IPv6 address in hexadecimal
     /// notation.
@@ -173,6 +182,29 @@ NETWORK_API address make_address(const std::string& str);
  */
 NETWORK_API address make_address(const std::string& str, std::error_code& ec);
 
+/**
+ * Create an address from the IPv4 or IPv6 text in [first, last).
+ * The text does not need to be null-terminated.
+ * @relates address
+ */
+NETWORK_API address make_address(const char* first, const char* last, std::error_code& ec);
+
+#if defined(NETWORK_HAS_STD_STRING_VIEW)
+/**
+ * Create an address from an IPv4 address string in dotted decimal form,
+ * or from an IPv6 address in hexadecimal notation.
+ * @relates address
+ */
+NETWORK_API address make_address(std::string_view str);
+
+/**
+ * Create an address from an IPv4 address string in dotted decimal form,
+ * or from an IPv6 address in hexadecimal notation.
+ * @relates address
+ */
+NETWORK_API address make_address(std::string_view str, std::error_code& ec);
+#endif // defined(NETWORK_HAS_STD_STRING_VIEW)
+
 /**
  * Output an address as a string.
  * Used to output a human-readable string for a specified address.
@@ -188,12 +220,30 @@ NETWORK_API address make_address(const std::string& str, std::error_code& ec);
 template <typename Elem, typename Traits>
 std::basic_ostream<Elem, Traits>& operator<<(std::basic_ostream<Elem, Traits>& os, const address& addr)
 {
-    return os << addr.to_string().c_str();
+    char buffer[max_addr_v6_str_len + 1];
+    *addr.to_chars(buffer, buffer + max_addr_v6_str_len) = '\0';
+    return os << buffer;
 }
 
 } // namespace ip
 } // namespace NetLite
 
+namespace std{
+
+/// Hash a version-independent IP address.
+template <>
+struct hash<NetLite::ip::address>
+{
+    std::size_t operator()(const NetLite::ip::address& addr) const noexcept
+    {
+        return addr.is_v4()
+            ? std::hash<NetLite::ip::address_v4>()(addr.to_v4())
+            : std::hash<NetLite::ip::address_v6>()(addr.to_v6());
+    }
+};
+
+} // namespace std
+
 #include "NetLite/ip/address.ipp"
 
 
@@ -6,6 +6,7 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+#include <cstring>
 #include "NetLite/ip/address.hpp"
 #include "NetLite/ip/bad_address_cast.hpp"
 namespace NetLite{
@@ -117,6 +118,13 @@ std::string address::to_string(std::error_code& ec) const
     return ipv4_address_.to_string(ec);
 }
 
+char* address::to_chars(char* first, char* last) const
+{
+    if (type_ == ipv6)
+        return ipv6_address_.to_chars(first, last);
+    return ipv4_address_.to_chars(first, last);
+}
+
 address address::from_string(const char* str)
 {
     return ip::make_address(str);
@@ -188,26 +196,56 @@ address make_address(const char* str)
 
 address make_address(const char* str, std::error_code& ec)
 {
-    ip::address_v6 ipv6_address = ip::make_address_v6(str, ec);
-    if (!ec)
-        return address(ipv6_address);
+    using namespace std; // For strlen.
+    return make_address(str, str + strlen(str), ec);
+}
 
-    ip::address_v4 ipv4_address = ip::make_address_v4(str, ec);
-    if (!ec)
-        return address(ipv4_address);
+address make_address(const std::string& str)
+{
+    std::error_code ec;
+    address addr = make_address(str.data(), str.data() + str.size(), ec);
+    if (ec) throw ec;
+    return addr;
+}
 
+address make_address(const std::string& str, std::error_code& ec)
+{
+    return make_address(str.data(), str.data() + str.size(), ec);
+}
+
+address make_address(const char* first, const char* last, std::error_code& ec)
+{
+    using namespace std; // For memchr.
+    // Only IPv6 text contains a colon, so a single parse is enough.
+    if (memchr(first, ':', static_cast<std::size_t>(last - first)))
+    {
+        ip::address_v6 ipv6_address = ip::make_address_v6(first, last, ec);
+        if (!ec)
+            return address(ipv6_address);
+    }
+    else
+    {
+        ip::address_v4 ipv4_address = ip::make_address_v4(first, last, ec);
+        if (!ec)
+            return address(ipv4_address);
+    }
     return address();
 }
 
-address make_address(const std::string& str)
+#if defined(NETWORK_HAS_STD_STRING_VIEW)
+address make_address(std::string_view str)
 {
-    return make_address(str.c_str());
+    std::error_code ec;
+    address addr = make_address(str.data(), str.data() + str.size(), ec);
+    if (ec) throw ec;
+    return addr;
 }
 
-address make_address(const std::string& str, std::error_code& ec)
+address make_address(std::string_view str, std::error_code& ec)
 {
-    return make_address(str.c_str(), ec);
+    return make_address(str.data(), str.data() + str.size(), ec);
 }
+#endif // defined(NETWORK_HAS_STD_STRING_VIEW)
 
 } // namespace ip
 } // namespace NetLite
@@ -12,10 +12,17 @@
 #include "NetLite/config.hpp"
 #include "NetLite/net_error_code.hpp"
 #include "NetLite/socket_types.hpp"
+#include "NetLite/detail/hash.hpp"
+#include "NetLite/detail/address_formatter.hpp"
+#if defined(NETWORK_HAS_STD_STRING_VIEW)
+# include <string_view>
+#endif // defined(NETWORK_HAS_STD_STRING_VIEW)
 
 namespace NetLite {
 namespace ip{
 
+class network_v4;
+
 /**
  * Implements IP version 4 style addresses.
  * The NetLite::ip::address_v4 class provides the ability to use and
@@ -97,6 +104,14 @@ public:
     /// decimal format.
     NETWORK_API std::string to_string(std::error_code& ec) const;
 
+    /**
+     * Write the address in dotted decimal format to [first, last) without allocating.
+     * No null terminator is written.
+     * @returns One past the last character written, or a null pointer if the
+     * range is too small.
+     */
+    NETWORK_API char* to_chars(char* first, char* last) const;
+
     /// (Deprecated: Use make_address_v4().) Create an address from an IP address
     /// string in dotted decimal form.
     NETWORK_API static address_v4 from_string(const char* str);
@@ -201,6 +216,8 @@ public:
 
 
 private:
+    friend class network_v4;
+
     // The underlying IPv4 address.
     NetLite::in4_addr_type addr_;
 };
@@ -247,6 +264,27 @@ NETWORK_API address_v4 make_address_v4(const std::string& str);
  */
 NETWORK_API address_v4 make_address_v4(const std::string& str, std::error_code& ec);
 
+/**
+ * Create an IPv4 address from the dotted decimal text in [first, last).
+ * The text does not need to be null-terminated.
+ * @relates address_v4
+ */
+NETWORK_API address_v4 make_address_v4(const char* first, const char* last, std::error_code& ec);
+
+#if defined(NETWORK_HAS_STD_STRING_VIEW)
+/**
+ * Create an IPv4 address from an IP address string in dotted decimal form.
+ * @relates address_v4
+ */
+NETWORK_API address_v4 make_address_v4(std::string_view str);
+
+/**
+ * Create an IPv4 address from an IP address string in dotted decimal form.
+ * @relates address_v4
+ */
+NETWORK_API address_v4 make_address_v4(std::string_view str, std::error_code& ec);
+#endif // defined(NETWORK_HAS_STD_STRING_VIEW)
+
 /**
  * Output an address as a string.
  * Used to output a human-readable string for a specified address.
@@ -262,12 +300,28 @@ NETWORK_API address_v4 make_address_v4(const std::string& str, std::error_code&
 template <typename Elem, typename Traits>
 std::basic_ostream<Elem, Traits>& operator<<(std::basic_ostream<Elem, Traits>& os, const address_v4& addr)
 {
-    return os << addr.to_string().c_str();
+    char buffer[detail::address_formatter::max_v4_length + 1];
+    *addr.to_chars(buffer, buffer + detail::address_formatter::max_v4_length) = '\0';
+    return os << buffer;
 }
 
 } // namespace ip
 } // namespace NetLite
 
+namespace std{
+
+/// Hash an IPv4 address.
+template <>
+struct hash<NetLite::ip::address_v4>
+{
+    std::size_t operator()(const NetLite::ip::address_v4& addr) const noexcept
+    {
+        return NetLite::detail::hash_in4(addr.to_uint());
+    }
+};
+
+} // namespace std
+
 #include "NetLite/ip/address_v4.ipp"
 
 
@@ -8,9 +8,11 @@
 
 #include <climits>
 #include <limits>
+#include <cstring>
 #include <stdexcept>
 #include "NetLite/ip/address_v4.hpp"
 #include "NetLite/socket_ops.hpp"
+#include "NetLite/detail/address_parser.hpp"
 
 namespace NetLite{
 namespace ip{
@@ -62,22 +64,22 @@ unsigned long address_v4::to_ulong() const
 
 std::string address_v4::to_string() const
 {
-    std::error_code ec;
-    char addr_str[max_addr_v4_str_len];
-    const char* addr = socket_ops::inet_ntop(NET_OS_DEF(AF_INET), &addr_, addr_str, max_addr_v4_str_len, 0, ec);
-    if (addr == 0)
-        throw(ec);
-    return addr;
+    char addr_str[detail::address_formatter::max_v4_length];
+    char* end = to_chars(addr_str, addr_str + sizeof(addr_str));
+    return std::string(addr_str, end);
 }
 
 
 std::string address_v4::to_string(std::error_code& ec) const
 {
-    char addr_str[max_addr_v4_str_len];
-    const char* addr = socket_ops::inet_ntop(NET_OS_DEF(AF_INET), &addr_, addr_str, max_addr_v4_str_len, 0, ec);
-    if (addr == 0)
-        return std::string();
-    return addr;
+    ec = std::error_code();
+    return to_string();
+}
+
+char* address_v4::to_chars(char* first, char* last) const
+{
+    return detail::address_formatter::format_v4(
+        reinterpret_cast<const unsigned char*>(&addr_.s_addr), first, last);
 }
 
 inline address_v4 address_v4::from_string(const char* str)
@@ -155,22 +157,50 @@ address_v4 make_address_v4(const char* str)
 }
 
 address_v4 make_address_v4(const char* str, std::error_code& ec)
+{
+    using namespace std; // For strlen.
+    return make_address_v4(str, str + strlen(str), ec);
+}
+
+address_v4 make_address_v4(const std::string& str)
+{
+    std::error_code ec;
+    address_v4 addr = make_address_v4(str.data(), str.data() + str.size(), ec);
+    if (ec) throw ec;
+    return addr;
+}
+
+address_v4 make_address_v4(const std::string& str, std::error_code& ec)
+{
+    return make_address_v4(str.data(), str.data() + str.size(), ec);
+}
+
+address_v4 make_address_v4(const char* first, const char* last, std::error_code& ec)
 {
     address_v4::bytes_type bytes;
-    if (socket_ops::inet_pton(NET_OS_DEF(AF_INET), str, &bytes, 0, ec) <= 0)
+    if (!detail::address_parser::parse_v4(first, last, bytes.data()))
+    {
+        ec = std::make_error_code(std::errc::invalid_argument);
         return address_v4();
+    }
+    ec = std::error_code();
     return address_v4(bytes);
 }
 
-address_v4 make_address_v4(const std::string& str)
+#if defined(NETWORK_HAS_STD_STRING_VIEW)
+address_v4 make_address_v4(std::string_view str)
 {
-    return make_address_v4(str.c_str());
+    std::error_code ec;
+    address_v4 addr = make_address_v4(str.data(), str.data() + str.size(), ec);
+    if (ec) throw ec;
+    return addr;
 }
 
-address_v4 make_address_v4( const std::string& str, std::error_code& ec)
+address_v4 make_address_v4(std::string_view str, std::error_code& ec)
 {
-    return make_address_v4(str.c_str(), ec);
+    return make_address_v4(str.data(), str.data() + str.size(), ec);
 }
+#endif // defined(NETWORK_HAS_STD_STRING_VIEW)
 
 } // namespace ip
 } // namespace NetLite
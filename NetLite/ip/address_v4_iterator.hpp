@@ -6,6 +6,8 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+#include <cstddef>
+#include <iterator>
 #include "NetLite/ip/address_v4.hpp"
 
 namespace NetLite{
@@ -15,9 +17,9 @@ template <typename>
 class basic_address_iterator;
 
 /**
- * An input iterator that can be used for traversing IPv4 addresses.
- * In addition to satisfying the input iterator requirements, this iterator
- * also supports decrement.
+ * A random access iterator that can be used for traversing IPv4 addresses.
+ * The iterator holds the address it points to, so references obtained from
+ * it are only valid until it is moved.
  *
  * @par Thread Safety
  * @e Distinct @e objects: Safe.@n
@@ -39,37 +41,37 @@ public:
     /// The type of a reference to an element pointed to by the iterator.
     typedef const address_v4& reference;
 
-    /// Denotes that the iterator satisfies the input iterator requirements.
-    typedef std::input_iterator_tag iterator_category;
+    /// Denotes that the iterator supports random access.
+    typedef std::random_access_iterator_tag iterator_category;
 
     /// Construct an iterator that points to the specified address.
-    basic_address_iterator(const address_v4& addr) _NOEXCEPT
+    basic_address_iterator(const address_v4& addr) noexcept
         : address_(addr)
     {
     }
 
     /// Copy constructor.
-    basic_address_iterator(const basic_address_iterator& other) _NOEXCEPT
+    basic_address_iterator(const basic_address_iterator& other) noexcept
         : address_(other.address_)
     {
     }
 
     /// Move constructor.
-    basic_address_iterator(basic_address_iterator&& other) _NOEXCEPT
+    basic_address_iterator(basic_address_iterator&& other) noexcept
         : address_(static_cast<address_v4&&>(other.address_))
     {
     }
 
 
     /// Assignment operator.
-    basic_address_iterator& operator=(const basic_address_iterator& other) _NOEXCEPT
+    basic_address_iterator& operator=(const basic_address_iterator& other) noexcept
     {
         address_ = other.address_;
         return *this;
     }
 
         /// Move assignment operator.
-        basic_address_iterator& operator=(basic_address_iterator&& other) _NOEXCEPT
+        basic_address_iterator& operator=(basic_address_iterator&& other) noexcept
     {
         address_ = static_cast<address_v4&&>(other.address_);
         return *this;
@@ -77,26 +79,26 @@ public:
 
 
         /// Dereference the iterator.
-        const address_v4& operator*() const _NOEXCEPT
+        const address_v4& operator*() const noexcept
     {
         return address_;
     }
 
         /// Dereference the iterator.
-        const address_v4* operator->() const _NOEXCEPT
+        const address_v4* operator->() const noexcept
     {
         return &address_;
     }
 
         /// Pre-increment operator.
-        basic_address_iterator& operator++() _NOEXCEPT
+        basic_address_iterator& operator++() noexcept
     {
         address_ = address_v4((address_.to_uint() + 1) & 0xFFFFFFFF);
         return *this;
     }
 
         /// Post-increment operator.
-        basic_address_iterator operator++(int)_NOEXCEPT
+        basic_address_iterator operator++(int)noexcept
     {
         basic_address_iterator tmp(*this);
         ++*this;
@@ -104,7 +106,7 @@ public:
     }
 
         /// Pre-decrement operator.
-        basic_address_iterator& operator--() _NOEXCEPT
+        basic_address_iterator& operator--() noexcept
     {
         address_ = address_v4((address_.to_uint() - 1) & 0xFFFFFFFF);
         return *this;
@@ -118,6 +120,53 @@ public:
         return tmp;
     }
 
+    /// Advance the iterator by n addresses, wrapping around at the end of
+    /// the address space.
+    basic_address_iterator& operator+=(difference_type n) noexcept
+    {
+        address_ = address_v4(static_cast<address_v4::uint_type>(
+            (address_.to_uint() + static_cast<address_v4::uint_type>(n)) & 0xFFFFFFFF));
+        return *this;
+    }
+
+    /// Move the iterator back by n addresses.
+    basic_address_iterator& operator-=(difference_type n) noexcept
+    {
+        return *this += -n;
+    }
+
+    /// Get the address n positions away.
+    address_v4 operator[](difference_type n) const noexcept
+    {
+        return *(*this + n);
+    }
+
+    /// Get an iterator advanced by n addresses.
+    friend basic_address_iterator operator+(basic_address_iterator it, difference_type n) noexcept
+    {
+        return it += n;
+    }
+
+    /// Get an iterator advanced by n addresses.
+    friend basic_address_iterator operator+(difference_type n, basic_address_iterator it) noexcept
+    {
+        return it += n;
+    }
+
+    /// Get an iterator moved back by n addresses.
+    friend basic_address_iterator operator-(basic_address_iterator it, difference_type n) noexcept
+    {
+        return it -= n;
+    }
+
+    /// Get the number of addresses between two iterators.
+    friend difference_type operator-(const basic_address_iterator& a,
+        const basic_address_iterator& b) noexcept
+    {
+        return static_cast<difference_type>(a.address_.to_uint())
+            - static_cast<difference_type>(b.address_.to_uint());
+    }
+
     /// Compare two addresses for equality.
     friend bool operator==(const basic_address_iterator& a,
         const basic_address_iterator& b)
@@ -132,11 +181,39 @@ public:
         return a.address_ != b.address_;
     }
 
+    /// Compare two iterators for ordering.
+    friend bool operator<(const basic_address_iterator& a,
+        const basic_address_iterator& b)
+    {
+        return a.address_ < b.address_;
+    }
+
+    /// Compare two iterators for ordering.
+    friend bool operator>(const basic_address_iterator& a,
+        const basic_address_iterator& b)
+    {
+        return b.address_ < a.address_;
+    }
+
+    /// Compare two iterators for ordering.
+    friend bool operator<=(const basic_address_iterator& a,
+        const basic_address_iterator& b)
+    {
+        return !(b.address_ < a.address_);
+    }
+
+    /// Compare two iterators for ordering.
+    friend bool operator>=(const basic_address_iterator& a,
+        const basic_address_iterator& b)
+    {
+        return !(a.address_ < b.address_);
+    }
+
 private:
     address_v4 address_;
 };
 
-/// An input iterator that can be used for traversing IPv4 addresses.
+/// A random access iterator that can be used for traversing IPv4 addresses.
 typedef basic_address_iterator<address_v4> address_v4_iterator;
 
 } // namespace ip
@@ -6,6 +6,9 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+#include <cstddef>
+#include <cstring>
+#include "NetLite/socket_ops.hpp"
 #include "NetLite/ip/address_v4_iterator.hpp"
 
 namespace NetLite {
@@ -28,35 +31,35 @@ public:
     typedef basic_address_iterator<address_v4> iterator;
 
     /// Construct an empty range.
-    basic_address_range() _NOEXCEPT
+    basic_address_range() noexcept
         : begin_(address_v4())
         , end_(address_v4())
     {
     }
 
     /// Construct an range that represents the given range of addresses.
-    explicit basic_address_range(const iterator& first, const iterator& last) _NOEXCEPT
+    explicit basic_address_range(const iterator& first, const iterator& last) noexcept
         : begin_(first)
         , end_(last)
     {
     }
 
     /// Copy constructor.
-    basic_address_range(const basic_address_range& other) _NOEXCEPT
+    basic_address_range(const basic_address_range& other) noexcept
         : begin_(other.begin_)
         , end_(other.end_)
     {
     }
 
     /// Move constructor.
-    basic_address_range(basic_address_range&& other) _NOEXCEPT
+    basic_address_range(basic_address_range&& other) noexcept
         : begin_(static_cast<iterator&&>(other.begin_))
         , end_(static_cast<iterator&&>(other.end_))
     {
     }
 
     /// Assignment operator.
-    basic_address_range& operator=(const basic_address_range& other) _NOEXCEPT
+    basic_address_range& operator=(const basic_address_range& other) noexcept
     {
         begin_ = other.begin_;
         end_ = other.end_;
@@ -64,7 +67,7 @@ public:
     }
 
     /// Move assignment operator.
-     basic_address_range& operator=(basic_address_range&& other) _NOEXCEPT
+     basic_address_range& operator=(basic_address_range&& other) noexcept
     {
         begin_ = static_cast<iterator&&>(other.begin_);
         end_ = static_cast<iterator&&>(other.end_);
@@ -73,35 +76,74 @@ public:
 
 
     /// Obtain an iterator that points to the start of the range.
-    iterator begin() const _NOEXCEPT
+    iterator begin() const noexcept
     {
         return begin_;
     }
 
     /// Obtain an iterator that points to the end of the range.
-    iterator end() const _NOEXCEPT
+    iterator end() const noexcept
     {
         return end_;
     }
 
     /// Determine whether the range is empty.
-    bool empty() const _NOEXCEPT
+    bool empty() const noexcept
     {
         return size() == 0;
     }
 
     /// Return the size of the range.
-    std::size_t size() const _NOEXCEPT
+    std::size_t size() const noexcept
     {
         return end_->to_uint() - begin_->to_uint();
     }
 
     /// Find an address in the range.
-    iterator find(const address_v4& addr) const _NOEXCEPT
+    iterator find(const address_v4& addr) const noexcept
     {
         return addr >= *begin_ && addr < *end_ ? iterator(addr) : end_;
     }
 
+    /**
+     * Fill an array with socket addresses for consecutive addresses of the
+     * range. Every element is a complete AF_INET address with the given port,
+     * ready to be used as the destination of a batched send.
+     *
+     * @param offset The position in the range of the first address.
+     *
+     * @param out The array to fill.
+     *
+     * @param count The number of elements in the array.
+     *
+     * @param port The port number, in the host's byte order.
+     *
+     * @returns The number of elements written, which is less than count when
+     * the range ends first.
+     */
+    std::size_t to_sockaddrs(std::size_t offset, sockaddr_in4_type* out,
+        std::size_t count, unsigned short port) const noexcept
+    {
+        const std::size_t total = size();
+        if (offset >= total)
+            return 0;
+        if (count > total - offset)
+            count = total - offset;
+
+        sockaddr_in4_type proto;
+        std::memset(&proto, 0, sizeof(proto));
+        proto.sin_family = NET_OS_DEF(AF_INET);
+        proto.sin_port = socket_ops::host_to_network_short(port);
+        const address_v4::uint_type first = static_cast<address_v4::uint_type>(begin_->to_uint() + offset);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            out[i] = proto;
+            out[i].sin_addr.s_addr = socket_ops::host_to_network_long(
+                static_cast<address_v4::uint_type>((first + i) & 0xFFFFFFFF));
+        }
+        return count;
+    }
+
 private:
     iterator begin_;
     iterator end_;
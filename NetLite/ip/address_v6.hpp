@@ -12,12 +12,14 @@
 #include "NetLite/config.hpp"
 #include "NetLite/net_error_code.hpp"
 #include "NetLite/socket_types.hpp"
+#include "NetLite/detail/hash.hpp"
 #include "NetLite/ip/address_v4.hpp"
 
 namespace NetLite{
 namespace ip
 {
 template <typename> class basic_address_iterator;
+class network_v6;
 
 /// Implements IP version 6 style addresses.
 /**
@@ -83,6 +85,14 @@ public:
     /// (Deprecated: Use other overload.) Get the address as a string.
     NETWORK_API std::string to_string(std::error_code& ec) const;
 
+    /**
+     * Write the address in RFC 5952 text form, including any scope suffix, to [first, last) without allocating.
+     * No null terminator is written.
+     * @returns One past the last character written, or a null pointer if the
+     * range is too small.
+     */
+    NETWORK_API char* to_chars(char* first, char* last) const;
+
     /// (Deprecated: Use make_address_v6().) Create an IPv6 address from an IP
     /// address string.
     NETWORK_API static address_v6 from_string(const char* str);
@@ -187,6 +197,7 @@ public:
 
 private:
     friend class basic_address_iterator<address_v6>;
+    friend class network_v6;
 
     // The underlying IPv6 address.
     in6_addr_type addr_;
@@ -228,6 +239,28 @@ NETWORK_API address_v6 make_address_v6(const std::string& str);
 */
 NETWORK_API address_v6 make_address_v6(const std::string& str, std::error_code& ec);
 
+/// Create an IPv6 address from the text in [first, last).
+/**
+* The text may carry a "%scope" suffix and does not need to be
+* null-terminated.
+* @relates address_v6
+*/
+NETWORK_API address_v6 make_address_v6(const char* first, const char* last, std::error_code& ec);
+
+#if defined(NETWORK_HAS_STD_STRING_VIEW)
+/// Create an IPv6 address from an IP address string.
+/**
+* @relates address_v6
+*/
+NETWORK_API address_v6 make_address_v6(std::string_view str);
+
+/// Create an IPv6 address from an IP address string.
+/**
+* @relates address_v6
+*/
+NETWORK_API address_v6 make_address_v6(std::string_view str, std::error_code& ec);
+#endif // defined(NETWORK_HAS_STD_STRING_VIEW)
+
 /// Tag type used for distinguishing overloads that deal in IPv4-mapped IPv6
 /// addresses.
 enum v4_mapped_t { v4_mapped };
@@ -259,12 +292,29 @@ NETWORK_API address_v6 make_address_v6(v4_mapped_t, const address_v4& v4_addr);
 template <typename Elem, typename Traits>
 std::basic_ostream<Elem, Traits>& operator<<(std::basic_ostream<Elem, Traits>& os, const address_v6& addr)
 {
-    return os << addr.to_string().c_str();
+    char buffer[max_addr_v6_str_len + 1];
+    *addr.to_chars(buffer, buffer + max_addr_v6_str_len) = '\0';
+    return os << buffer;
 }
 
 } // namespace ip
 } // namespace NetLite
 
+namespace std{
+
+/// Hash an IPv6 address, including its scope ID.
+template <>
+struct hash<NetLite::ip::address_v6>
+{
+    std::size_t operator()(const NetLite::ip::address_v6& addr) const noexcept
+    {
+        const NetLite::ip::address_v6::bytes_type bytes = addr.to_bytes();
+        return NetLite::detail::hash_in6(bytes.data(), addr.scope_id());
+    }
+};
+
+} // namespace std
+
 #include "NetLite/ip/address_v6.ipp"
 
 
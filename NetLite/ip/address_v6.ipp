@@ -12,6 +12,7 @@
 #include "NetLite/socket_ops.hpp"
 #include "NetLite/ip/address_v6.hpp"
 #include "NetLite/ip/bad_address_cast.hpp"
+#include "NetLite/detail/address_parser.hpp"
 
 namespace NetLite {
 namespace ip
@@ -78,21 +79,20 @@ address_v6::bytes_type address_v6::to_bytes() const
 
 std::string address_v6::to_string() const
 {
-	std::error_code ec;
 	char addr_str[max_addr_v6_str_len];
-	const char* addr =socket_ops::inet_ntop(NET_OS_DEF(AF_INET6), &addr_, addr_str,max_addr_v6_str_len, scope_id_, ec);
-	if (addr == 0)
-		throw ec;
-	return addr;
+	char* end = to_chars(addr_str, addr_str + sizeof(addr_str));
+	return std::string(addr_str, end);
 }
 
 std::string address_v6::to_string(std::error_code& ec) const
 {
-	char addr_str[max_addr_v6_str_len];
-	const char* addr =socket_ops::inet_ntop(NET_OS_DEF(AF_INET6), &addr_, addr_str,max_addr_v6_str_len, scope_id_, ec);
-	if (addr == 0)
-		return std::string();
-	return addr;
+	ec = std::error_code();
+	return to_string();
+}
+
+char* address_v6::to_chars(char* first, char* last) const
+{
+	return detail::address_formatter::format_v6(addr_.s6_addr, scope_id_, first, last);
 }
 
 inline address_v6 address_v6::from_string(const char* str)
@@ -265,23 +265,51 @@ address_v6 make_address_v6(const char* str)
 }
 
 address_v6 make_address_v6(const char* str, std::error_code& ec)
+{
+	using namespace std; // For strlen.
+	return make_address_v6(str, str + strlen(str), ec);
+}
+
+address_v6 make_address_v6(const std::string& str)
+{
+	std::error_code ec;
+	address_v6 addr = make_address_v6(str.data(), str.data() + str.size(), ec);
+	if (ec) throw ec;
+	return addr;
+}
+
+address_v6 make_address_v6(const std::string& str, std::error_code& ec)
+{
+	return make_address_v6(str.data(), str.data() + str.size(), ec);
+}
+
+address_v6 make_address_v6(const char* first, const char* last, std::error_code& ec)
 {
 	address_v6::bytes_type bytes;
 	unsigned long scope_id = 0;
-	if (socket_ops::inet_pton(NET_OS_DEF(AF_INET6), str, &bytes[0], &scope_id, ec) <= 0)
+	if (!detail::address_parser::parse_v6(first, last, bytes.data(), &scope_id))
+	{
+		ec = std::make_error_code(std::errc::invalid_argument);
 		return address_v6();
+	}
+	ec = std::error_code();
 	return address_v6(bytes, scope_id);
 }
 
-address_v6 make_address_v6(const std::string& str)
+#if defined(NETWORK_HAS_STD_STRING_VIEW)
+address_v6 make_address_v6(std::string_view str)
 {
-	return make_address_v6(str.c_str());
+	std::error_code ec;
+	address_v6 addr = make_address_v6(str.data(), str.data() + str.size(), ec);
+	if (ec) throw ec;
+	return addr;
 }
 
-address_v6 make_address_v6(const std::string& str, std::error_code& ec)
+address_v6 make_address_v6(std::string_view str, std::error_code& ec)
 {
-	return make_address_v6(str.c_str(), ec);
+	return make_address_v6(str.data(), str.data() + str.size(), ec);
 }
+#endif // defined(NETWORK_HAS_STD_STRING_VIEW)
 
 address_v4 make_address_v4(v4_mapped_t, const address_v6& v6_addr)
 {
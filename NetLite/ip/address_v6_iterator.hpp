@@ -6,6 +6,9 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include "NetLite/ip/address_v6.hpp"
 
 namespace NetLite {
@@ -14,10 +17,11 @@ namespace ip{
 template <typename>
 class basic_address_iterator;
 
-/// An input iterator that can be used for traversing IPv6 addresses.
+/// A random access iterator that can be used for traversing IPv6 addresses.
 /**
-* In addition to satisfying the input iterator requirements, this iterator
-* also supports decrement.
+* The iterator holds the address it points to, so references obtained from
+* it are only valid until it is moved. Distances are 128-bit differences
+* truncated to difference_type.
 *
 * @par Thread Safety
 * @e Distinct @e objects: Safe.@n
@@ -39,30 +43,30 @@ public:
     /// The type of a reference to an element pointed to by the iterator.
     typedef const address_v6& reference;
 
-    /// Denotes that the iterator satisfies the input iterator requirements.
-    typedef std::input_iterator_tag iterator_category;
+    /// Denotes that the iterator supports random access.
+    typedef std::random_access_iterator_tag iterator_category;
 
     /// Construct an iterator that points to the specified address.
-    basic_address_iterator(const address_v6& addr) _NOEXCEPT
+    basic_address_iterator(const address_v6& addr) noexcept
         : address_(addr)
     {
     }
 
     /// Copy constructor.
-    basic_address_iterator(const basic_address_iterator& other) _NOEXCEPT
+    basic_address_iterator(const basic_address_iterator& other) noexcept
         : address_(other.address_)
     {
     }
 
     /// Move constructor.
-    basic_address_iterator(basic_address_iterator&& other) _NOEXCEPT
+    basic_address_iterator(basic_address_iterator&& other) noexcept
         : address_(static_cast<address_v6&&>(other.address_))
     {
     }
 
 
     /// Assignment operator.
-    basic_address_iterator& operator=(const basic_address_iterator& other) _NOEXCEPT
+    basic_address_iterator& operator=(const basic_address_iterator& other) noexcept
     {
         address_ = other.address_;
         return *this;
@@ -70,7 +74,7 @@ public:
 
 
     /// Move assignment operator.
-    basic_address_iterator& operator=(basic_address_iterator&& other) _NOEXCEPT
+    basic_address_iterator& operator=(basic_address_iterator&& other) noexcept
     {
         address_ = static_cast<address_v6&&>(other.address_);
         return *this;
@@ -78,19 +82,19 @@ public:
 
 
     /// Dereference the iterator.
-    const address_v6& operator*() const _NOEXCEPT
+    const address_v6& operator*() const noexcept
     {
         return address_;
     }
 
     /// Dereference the iterator.
-    const address_v6* operator->() const _NOEXCEPT
+    const address_v6* operator->() const noexcept
     {
         return &address_;
     }
 
     /// Pre-increment operator.
-    basic_address_iterator& operator++() _NOEXCEPT
+    basic_address_iterator& operator++() noexcept
     {
         for (int i = 15; i >= 0; --i)
         {
@@ -107,7 +111,7 @@ public:
     }
 
     /// Post-increment operator.
-    basic_address_iterator operator++(int)_NOEXCEPT
+    basic_address_iterator operator++(int)noexcept
     {
         basic_address_iterator tmp(*this);
         ++*this;
@@ -115,7 +119,7 @@ public:
     }
 
     /// Pre-decrement operator.
-    basic_address_iterator& operator--() _NOEXCEPT
+    basic_address_iterator& operator--() noexcept
     {
         for (int i = 15; i >= 0; --i)
         {
@@ -139,6 +143,59 @@ public:
         return tmp;
     }
 
+    /// Advance the iterator by n addresses, wrapping around at the end of
+    /// the address space.
+    basic_address_iterator& operator+=(difference_type n) noexcept
+    {
+        uint64_t high, low;
+        load(address_, high, low);
+        const uint64_t sum = low + static_cast<uint64_t>(n);
+        // Add n sign-extended to 128 bits.
+        high += (n < 0 ? ~static_cast<uint64_t>(0) : 0) + (sum < low ? 1 : 0);
+        store(address_, high, sum);
+        return *this;
+    }
+
+    /// Move the iterator back by n addresses.
+    basic_address_iterator& operator-=(difference_type n) noexcept
+    {
+        return *this += -n;
+    }
+
+    /// Get the address n positions away.
+    address_v6 operator[](difference_type n) const noexcept
+    {
+        return *(*this + n);
+    }
+
+    /// Get an iterator advanced by n addresses.
+    friend basic_address_iterator operator+(basic_address_iterator it, difference_type n) noexcept
+    {
+        return it += n;
+    }
+
+    /// Get an iterator advanced by n addresses.
+    friend basic_address_iterator operator+(difference_type n, basic_address_iterator it) noexcept
+    {
+        return it += n;
+    }
+
+    /// Get an iterator moved back by n addresses.
+    friend basic_address_iterator operator-(basic_address_iterator it, difference_type n) noexcept
+    {
+        return it -= n;
+    }
+
+    /// Get the number of addresses between two iterators.
+    friend difference_type operator-(const basic_address_iterator& a,
+        const basic_address_iterator& b) noexcept
+    {
+        uint64_t a_high, a_low, b_high, b_low;
+        load(a.address_, a_high, a_low);
+        load(b.address_, b_high, b_low);
+        return static_cast<difference_type>(a_low - b_low);
+    }
+
     /// Compare two addresses for equality.
     friend bool operator==(const basic_address_iterator& a, const basic_address_iterator& b)
     {
@@ -151,11 +208,59 @@ public:
         return a.address_ != b.address_;
     }
 
+    /// Compare two iterators for ordering.
+    friend bool operator<(const basic_address_iterator& a, const basic_address_iterator& b)
+    {
+        return a.address_ < b.address_;
+    }
+
+    /// Compare two iterators for ordering.
+    friend bool operator>(const basic_address_iterator& a, const basic_address_iterator& b)
+    {
+        return b.address_ < a.address_;
+    }
+
+    /// Compare two iterators for ordering.
+    friend bool operator<=(const basic_address_iterator& a, const basic_address_iterator& b)
+    {
+        return !(b.address_ < a.address_);
+    }
+
+    /// Compare two iterators for ordering.
+    friend bool operator>=(const basic_address_iterator& a, const basic_address_iterator& b)
+    {
+        return !(a.address_ < b.address_);
+    }
+
 private:
+    // Split an address into two host order words, most significant first.
+    static void load(const address_v6& addr, uint64_t& high, uint64_t& low) noexcept
+    {
+        high = 0;
+        low = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            high = (high << 8) | addr.addr_.s6_addr[i];
+            low = (low << 8) | addr.addr_.s6_addr[i + 8];
+        }
+    }
+
+    // Store two host order words into an address, most significant first.
+    static void store(address_v6& addr, uint64_t high, uint64_t low) noexcept
+    {
+        for (int i = 7; i >= 0; --i)
+        {
+            addr.addr_.s6_addr[i] = static_cast<unsigned char>(high);
+            addr.addr_.s6_addr[i + 8] = static_cast<unsigned char>(low);
+            high >>= 8;
+            low >>= 8;
+        }
+    }
+
     address_v6 address_;
 };
 
-/// An input iterator that can be used for traversing IPv6 addresses.
+/// A random access iterator that can be used for traversing IPv6 addresses.
 typedef basic_address_iterator<address_v6> address_v6_iterator;
 
 } // namespace ip
@@ -6,7 +6,13 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "NetLite/socket_ops.hpp"
 #include "NetLite/ip/address_v6_iterator.hpp"
+
 namespace NetLite{
 namespace ip{
 
@@ -22,35 +28,35 @@ public:
     typedef basic_address_iterator<address_v6> iterator;
 
     /// Construct an empty range.
-    basic_address_range() _NOEXCEPT
+    basic_address_range() noexcept
         : begin_(address_v6())
         , end_(address_v6())
     {
     }
 
     /// Construct an range that represents the given range of addresses.
-    explicit basic_address_range(const iterator& first, const iterator& last) _NOEXCEPT
+    explicit basic_address_range(const iterator& first, const iterator& last) noexcept
         : begin_(first)
         , end_(last)
     {
     }
 
     /// Copy constructor.
-    basic_address_range(const basic_address_range& other) _NOEXCEPT
+    basic_address_range(const basic_address_range& other) noexcept
         : begin_(other.begin_)
         , end_(other.end_)
     {
     }
 
     /// Move constructor.
-    basic_address_range(basic_address_range&& other) _NOEXCEPT
+    basic_address_range(basic_address_range&& other) noexcept
         : begin_(static_cast<iterator&&>(other.begin_))
         , end_(static_cast<iterator&&>(other.end_))
     {
     }
 
     /// Assignment operator.
-    basic_address_range& operator=( const basic_address_range& other) _NOEXCEPT
+    basic_address_range& operator=( const basic_address_range& other) noexcept
     {
         begin_ = other.begin_;
         end_ = other.end_;
@@ -58,7 +64,7 @@ public:
     }
 
     /// Move assignment operator.
-    basic_address_range& operator=(basic_address_range&& other) _NOEXCEPT
+    basic_address_range& operator=(basic_address_range&& other) noexcept
     {
         begin_ = static_cast<iterator&&>(other.begin_);
         end_ = static_cast<iterator&&>(other.end_);
@@ -67,29 +73,92 @@ public:
 
 
     /// Obtain an iterator that points to the start of the range.
-    iterator begin() const _NOEXCEPT
+    iterator begin() const noexcept
     {
         return begin_;
     }
 
     /// Obtain an iterator that points to the end of the range.
-    iterator end() const _NOEXCEPT
+    iterator end() const noexcept
     {
         return end_;
     }
 
     /// Determine whether the range is empty.
-    bool empty() const _NOEXCEPT
+    bool empty() const noexcept
     {
         return begin_ == end_;
     }
 
+    /// Return the size of the range, saturated at the largest std::size_t.
+    std::size_t size() const noexcept
+    {
+        if (!(begin_ < end_))
+            return 0;
+        const address_v6::bytes_type first = begin_->to_bytes();
+        const address_v6::bytes_type last = end_->to_bytes();
+        uint64_t first_high = 0, first_low = 0, last_high = 0, last_low = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            first_high = (first_high << 8) | first[i];
+            first_low = (first_low << 8) | first[i + 8];
+            last_high = (last_high << 8) | last[i];
+            last_low = (last_low << 8) | last[i + 8];
+        }
+        const uint64_t low = last_low - first_low;
+        const uint64_t high = last_high - first_high - (last_low < first_low ? 1 : 0);
+        if (high != 0 || low > static_cast<uint64_t>((std::numeric_limits<std::size_t>::max)()))
+            return (std::numeric_limits<std::size_t>::max)();
+        return static_cast<std::size_t>(low);
+    }
+
     /// Find an address in the range.
-    iterator find(const address_v6& addr) const _NOEXCEPT
+    iterator find(const address_v6& addr) const noexcept
     {
         return addr >= *begin_ && addr < *end_ ? iterator(addr) : end_;
     }
 
+    /**
+     * Fill an array with socket addresses for consecutive addresses of the
+     * range. Every element is a complete AF_INET6 address with the given port
+     * and the scope ID of the first address, ready to be used as the
+     * destination of a batched send.
+     *
+     * @param offset The position in the range of the first address.
+     *
+     * @param out The array to fill.
+     *
+     * @param count The number of elements in the array.
+     *
+     * @param port The port number, in the host's byte order.
+     *
+     * @returns The number of elements written, which is less than count when
+     * the range ends first.
+     */
+    std::size_t to_sockaddrs(std::size_t offset, sockaddr_in6_type* out,
+        std::size_t count, unsigned short port) const noexcept
+    {
+        const std::size_t total = size();
+        if (offset >= total)
+            return 0;
+        if (count > total - offset)
+            count = total - offset;
+
+        sockaddr_in6_type proto;
+        std::memset(&proto, 0, sizeof(proto));
+        proto.sin6_family = NET_OS_DEF(AF_INET6);
+        proto.sin6_port = socket_ops::host_to_network_short(port);
+        proto.sin6_scope_id = static_cast<uint32_t>(begin_->scope_id());
+        iterator it = begin_ + static_cast<iterator::difference_type>(offset);
+        for (std::size_t i = 0; i < count; ++i, ++it)
+        {
+            out[i] = proto;
+            const address_v6::bytes_type bytes = it->to_bytes();
+            std::memcpy(out[i].sin6_addr.s6_addr, bytes.data(), 16);
+        }
+        return count;
+    }
+
 private:
     iterator begin_;
     iterator end_;
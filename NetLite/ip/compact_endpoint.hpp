@@ -0,0 +1,269 @@
+#ifndef NETLITE_COMPACT_ENDPOINT_HPP
+#define NETLITE_COMPACT_ENDPOINT_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "NetLite/config.hpp"
+#include "NetLite/socket_types.hpp"
+#include "NetLite/basic_endpoint.hpp"
+#include "NetLite/detail/hash.hpp"
+#include "NetLite/ip/address.hpp"
+#include "NetLite/ip/endpoint.hpp"
+
+namespace NetLite{
+namespace ip{
+
+/**
+ * A packed IPv4 or IPv6 endpoint for large tables keyed by peer.
+ *
+ * The object is 20 bytes: a family tag, the port and sixteen address bytes,
+ * all in network byte order, with IPv4 addresses in the first four bytes and
+ * the rest zeroed. Equality, ordering and hashing work directly on those
+ * bytes. The IPv6 flow label and scope ID are not kept, so link-local peers
+ * on different interfaces compare equal.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+class compact_endpoint
+{
+public:
+    /// Default constructor, 0.0.0.0 port 0.
+    compact_endpoint() noexcept
+        : family_(v4_tag)
+        , reserved_(0)
+        , port_(0)
+    {
+        std::memset(addr_, 0, sizeof(addr_));
+    }
+
+    /// Construct from an address and a port in the host's byte order.
+    NETWORK_API compact_endpoint(const ip::address& addr, unsigned short port_num);
+
+    /// Construct from an AF_INET or AF_INET6 socket address.
+    NETWORK_API explicit compact_endpoint(const socket_addr_type* addr);
+
+    /// Construct from an endpoint.
+    explicit compact_endpoint(const ip::endpoint& ep)
+    {
+        assign(ep.data());
+    }
+
+    /// Construct from an endpoint.
+    template <typename InternetProtocol>
+    explicit compact_endpoint(const basic_endpoint<InternetProtocol>& ep)
+    {
+        assign(ep.data());
+    }
+
+    /// Convert to an endpoint of the given protocol.
+    template <typename InternetProtocol>
+    basic_endpoint<InternetProtocol> to_endpoint() const
+    {
+        basic_endpoint<InternetProtocol> ep;
+        ep.resize(to_sockaddr(ep.data()));
+        return ep;
+    }
+
+    /**
+     * Write the endpoint as a socket address into storage that can hold at
+     * least a sockaddr_in6.
+     * @returns The size of the socket address written.
+     */
+    NETWORK_API std::size_t to_sockaddr(socket_addr_type* out) const noexcept;
+
+    /// Determine whether the endpoint is IPv4.
+    bool is_v4() const noexcept
+    {
+        return family_ == v4_tag;
+    }
+
+    /// Get the port in the host's byte order.
+    NETWORK_API unsigned short port() const noexcept;
+
+    /// Get the IP address.
+    NETWORK_API ip::address address() const;
+
+    /// Compare two endpoints for equality.
+    friend bool operator==(const compact_endpoint& e1, const compact_endpoint& e2) noexcept
+    {
+        return std::memcmp(&e1, &e2, sizeof(compact_endpoint)) == 0;
+    }
+
+    /// Compare two endpoints for inequality.
+    friend bool operator!=(const compact_endpoint& e1, const compact_endpoint& e2) noexcept
+    {
+        return !(e1 == e2);
+    }
+
+    /// Compare endpoints for ordering: IPv4 before IPv6, then by address
+    /// bytes, then by port bytes.
+    friend bool operator<(const compact_endpoint& e1, const compact_endpoint& e2) noexcept
+    {
+        if (e1.family_ != e2.family_)
+            return e1.family_ < e2.family_;
+        const int c = std::memcmp(e1.addr_, e2.addr_, sizeof(e1.addr_));
+        if (c != 0)
+            return c < 0;
+        return std::memcmp(&e1.port_, &e2.port_, sizeof(e1.port_)) < 0;
+    }
+
+    /// Get a hash of the endpoint.
+    std::size_t hash() const noexcept
+    {
+        return static_cast<std::size_t>(detail::hash_combine(
+            detail::hash_in6(addr_, family_), port_));
+    }
+
+private:
+    enum { v4_tag = 4, v6_tag = 6 };
+
+    NETWORK_API void assign(const socket_addr_type* addr);
+
+    unsigned char family_;
+    unsigned char reserved_;
+
+    // The port in network byte order.
+    uint16_t port_;
+
+    // The address in network byte order.
+    unsigned char addr_[16];
+};
+
+/**
+ * A packed IPv4 endpoint: the address and port in network byte order,
+ * 8 bytes in total.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+class compact_endpoint_v4
+{
+public:
+    /// Default constructor, 0.0.0.0 port 0.
+    compact_endpoint_v4() noexcept
+        : addr_(0)
+        , port_(0)
+        , reserved_(0)
+    {
+    }
+
+    /// Construct from an address and a port in the host's byte order.
+    NETWORK_API compact_endpoint_v4(const address_v4& addr, unsigned short port_num) noexcept;
+
+    /// Construct from an AF_INET socket address.
+    NETWORK_API explicit compact_endpoint_v4(const sockaddr_in4_type* addr) noexcept;
+
+    /// Construct from an IPv4 endpoint.
+    /// @throws bad_address_cast if the endpoint is not IPv4.
+    template <typename InternetProtocol>
+    explicit compact_endpoint_v4(const basic_endpoint<InternetProtocol>& ep)
+        : addr_(0)
+        , port_(0)
+        , reserved_(0)
+    {
+        if (ep.data()->sa_family != NET_OS_DEF(AF_INET))
+        {
+            bad_address_cast ex;
+            throw ex;
+        }
+        const sockaddr_in4_type* v4 = reinterpret_cast<const sockaddr_in4_type*>(ep.data());
+        addr_ = v4->sin_addr.s_addr;
+        port_ = v4->sin_port;
+    }
+
+    /// Convert to an endpoint of the given protocol.
+    template <typename InternetProtocol>
+    basic_endpoint<InternetProtocol> to_endpoint() const
+    {
+        basic_endpoint<InternetProtocol> ep;
+        ep.resize(to_sockaddr(reinterpret_cast<sockaddr_in4_type*>(ep.data())));
+        return ep;
+    }
+
+    /**
+     * Write the endpoint as a socket address.
+     * @returns The size of the socket address written.
+     */
+    NETWORK_API std::size_t to_sockaddr(sockaddr_in4_type* out) const noexcept;
+
+    /// Get the port in the host's byte order.
+    NETWORK_API unsigned short port() const noexcept;
+
+    /// Get the IP address.
+    NETWORK_API address_v4 address() const noexcept;
+
+    /// Compare two endpoints for equality.
+    friend bool operator==(const compact_endpoint_v4& e1, const compact_endpoint_v4& e2) noexcept
+    {
+        return e1.addr_ == e2.addr_ && e1.port_ == e2.port_;
+    }
+
+    /// Compare two endpoints for inequality.
+    friend bool operator!=(const compact_endpoint_v4& e1, const compact_endpoint_v4& e2) noexcept
+    {
+        return !(e1 == e2);
+    }
+
+    /// Compare endpoints for ordering, by address and then by port.
+    friend bool operator<(const compact_endpoint_v4& e1, const compact_endpoint_v4& e2) noexcept
+    {
+        if (e1.addr_ != e2.addr_)
+            return e1.address() < e2.address();
+        return e1.port() < e2.port();
+    }
+
+    /// Get a hash of the endpoint.
+    std::size_t hash() const noexcept
+    {
+        return static_cast<std::size_t>(detail::hash_mix(
+            (static_cast<uint64_t>(port_) << 32) | addr_));
+    }
+
+private:
+    // The address in network byte order.
+    uint32_t addr_;
+
+    // The port in network byte order.
+    uint16_t port_;
+
+    uint16_t reserved_;
+};
+
+} // namespace ip
+} // namespace NetLite
+
+namespace std{
+
+/// Hash a compact endpoint.
+template <>
+struct hash<NetLite::ip::compact_endpoint>
+{
+    std::size_t operator()(const NetLite::ip::compact_endpoint& ep) const noexcept
+    {
+        return ep.hash();
+    }
+};
+
+/// Hash a compact IPv4 endpoint.
+template <>
+struct hash<NetLite::ip::compact_endpoint_v4>
+{
+    std::size_t operator()(const NetLite::ip::compact_endpoint_v4& ep) const noexcept
+    {
+        return ep.hash();
+    }
+};
+
+} // namespace std
+
+#include "NetLite/ip/compact_endpoint.ipp"
+
+#endif // END OF NETLITE_COMPACT_ENDPOINT_HPP
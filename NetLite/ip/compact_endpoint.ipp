@@ -0,0 +1,140 @@
+#ifndef NETLITE_COMPACT_ENDPOINT_IPP
+#define NETLITE_COMPACT_ENDPOINT_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstring>
+#include "NetLite/socket_ops.hpp"
+#include "NetLite/ip/compact_endpoint.hpp"
+
+namespace NetLite{
+namespace ip{
+
+static_assert(sizeof(compact_endpoint) == 20, "compact_endpoint must be packed");
+static_assert(sizeof(compact_endpoint_v4) == 8, "compact_endpoint_v4 must be packed");
+
+compact_endpoint::compact_endpoint(const ip::address& addr, unsigned short port_num)
+    : family_(v4_tag)
+    , reserved_(0)
+    , port_(socket_ops::host_to_network_short(port_num))
+{
+    using namespace std; // For memcpy and memset.
+    memset(addr_, 0, sizeof(addr_));
+    if (addr.is_v4())
+    {
+        const address_v4::bytes_type bytes = addr.to_v4().to_bytes();
+        memcpy(addr_, bytes.data(), 4);
+    }
+    else
+    {
+        family_ = v6_tag;
+        const address_v6::bytes_type bytes = addr.to_v6().to_bytes();
+        memcpy(addr_, bytes.data(), 16);
+    }
+}
+
+compact_endpoint::compact_endpoint(const socket_addr_type* addr)
+{
+    assign(addr);
+}
+
+void compact_endpoint::assign(const socket_addr_type* addr)
+{
+    using namespace std; // For memcpy and memset.
+    reserved_ = 0;
+    memset(addr_, 0, sizeof(addr_));
+    if (addr->sa_family == NET_OS_DEF(AF_INET))
+    {
+        const sockaddr_in4_type* v4 = reinterpret_cast<const sockaddr_in4_type*>(addr);
+        family_ = v4_tag;
+        port_ = v4->sin_port;
+        memcpy(addr_, &v4->sin_addr, 4);
+    }
+    else
+    {
+        const sockaddr_in6_type* v6 = reinterpret_cast<const sockaddr_in6_type*>(addr);
+        family_ = v6_tag;
+        port_ = v6->sin6_port;
+        memcpy(addr_, &v6->sin6_addr, 16);
+    }
+}
+
+std::size_t compact_endpoint::to_sockaddr(socket_addr_type* out) const noexcept
+{
+    using namespace std; // For memcpy and memset.
+    if (is_v4())
+    {
+        sockaddr_in4_type* v4 = reinterpret_cast<sockaddr_in4_type*>(out);
+        memset(v4, 0, sizeof(sockaddr_in4_type));
+        v4->sin_family = NET_OS_DEF(AF_INET);
+        v4->sin_port = port_;
+        memcpy(&v4->sin_addr, addr_, 4);
+        return sizeof(sockaddr_in4_type);
+    }
+    sockaddr_in6_type* v6 = reinterpret_cast<sockaddr_in6_type*>(out);
+    memset(v6, 0, sizeof(sockaddr_in6_type));
+    v6->sin6_family = NET_OS_DEF(AF_INET6);
+    v6->sin6_port = port_;
+    memcpy(&v6->sin6_addr, addr_, 16);
+    return sizeof(sockaddr_in6_type);
+}
+
+unsigned short compact_endpoint::port() const noexcept
+{
+    return socket_ops::network_to_host_short(port_);
+}
+
+ip::address compact_endpoint::address() const
+{
+    using namespace std; // For memcpy.
+    if (is_v4())
+    {
+        address_v4::bytes_type bytes;
+        memcpy(bytes.data(), addr_, 4);
+        return address_v4(bytes);
+    }
+    address_v6::bytes_type bytes;
+    memcpy(bytes.data(), addr_, 16);
+    return address_v6(bytes);
+}
+
+compact_endpoint_v4::compact_endpoint_v4(const address_v4& addr, unsigned short port_num) noexcept
+    : addr_(socket_ops::host_to_network_long(addr.to_uint()))
+    , port_(socket_ops::host_to_network_short(port_num))
+    , reserved_(0)
+{
+}
+
+compact_endpoint_v4::compact_endpoint_v4(const sockaddr_in4_type* addr) noexcept
+    : addr_(addr->sin_addr.s_addr)
+    , port_(addr->sin_port)
+    , reserved_(0)
+{
+}
+
+std::size_t compact_endpoint_v4::to_sockaddr(sockaddr_in4_type* out) const noexcept
+{
+    using namespace std; // For memset.
+    memset(out, 0, sizeof(sockaddr_in4_type));
+    out->sin_family = NET_OS_DEF(AF_INET);
+    out->sin_port = port_;
+    out->sin_addr.s_addr = addr_;
+    return sizeof(sockaddr_in4_type);
+}
+
+unsigned short compact_endpoint_v4::port() const noexcept
+{
+    return socket_ops::network_to_host_short(port_);
+}
+
+address_v4 compact_endpoint_v4::address() const noexcept
+{
+    return address_v4(socket_ops::network_to_host_long(addr_));
+}
+
+} // namespace ip
+} // namespace NetLite
+
+#endif // END OF NETLITE_COMPACT_ENDPOINT_IPP
@@ -10,6 +10,7 @@
 #include "NetLite/config.hpp"
 #include "NetLite/net_error_code.hpp"
 #include "NetLite/socket_types.hpp"
+#include "NetLite/detail/hash.hpp"
 #include "NetLite/ip/address.hpp"
 
 namespace NetLite{
@@ -112,6 +113,20 @@ private:
 } // namespace ip
 } // namespace NetLite
 
+namespace std{
+
+/// Hash an endpoint from its raw socket address.
+template <>
+struct hash<NetLite::ip::endpoint>
+{
+    std::size_t operator()(const NetLite::ip::endpoint& ep) const noexcept
+    {
+        return NetLite::detail::hash_sockaddr(ep.data());
+    }
+};
+
+} // namespace std
+
 # include "NetLite/ip/endpoint.ipp"
 
 
@@ -127,7 +127,18 @@ void endpoint::address(const ip::address& addr)
 
 bool operator==(const endpoint& e1, const endpoint& e2)
 {
-    return e1.address() == e2.address() && e1.port() == e2.port();
+    // Compare the raw fields rather than building address objects.
+    using namespace std; // For memcmp.
+    if (e1.data_.base.sa_family != e2.data_.base.sa_family)
+        return false;
+    if (e1.is_v4())
+    {
+        return e1.data_.v4.sin_port == e2.data_.v4.sin_port
+            && e1.data_.v4.sin_addr.s_addr == e2.data_.v4.sin_addr.s_addr;
+    }
+    return e1.data_.v6.sin6_port == e2.data_.v6.sin6_port
+        && memcmp(&e1.data_.v6.sin6_addr, &e2.data_.v6.sin6_addr, sizeof(in6_addr_type)) == 0
+        && e1.data_.v6.sin6_scope_id == e2.data_.v6.sin6_scope_id;
 }
 
 bool operator<(const endpoint& e1, const endpoint& e2)
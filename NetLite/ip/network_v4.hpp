@@ -0,0 +1,217 @@
+#ifndef NETLITE_NETWORK_V4_HPP
+#define NETLITE_NETWORK_V4_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstdint>
+#include <string>
+#include "NetLite/config.hpp"
+#include "NetLite/net_error_code.hpp"
+#include "NetLite/socket_types.hpp"
+#include "NetLite/ip/address_v4.hpp"
+#include "NetLite/ip/address_v4_range.hpp"
+
+namespace NetLite{
+namespace ip{
+
+/**
+ * Represents an IPv4 network: an address and a prefix length.
+ *
+ * The netmask is kept in network byte order next to the address, so
+ * contains() is a single mask and compare on the raw in_addr.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+class network_v4
+{
+public:
+    /// Default constructor, the 0.0.0.0/0 network.
+    network_v4() noexcept
+        : address_()
+        , prefix_length_(0)
+        , mask_(0)
+    {
+    }
+
+    /// Construct a network based on the specified address and prefix length.
+    NETWORK_API network_v4(const address_v4& addr, unsigned short prefix_len);
+
+    /// Construct a network based on the specified address and netmask.
+    NETWORK_API network_v4(const address_v4& addr, const address_v4& mask);
+
+    /// Obtain the address object specified when the network object was created.
+    address_v4 address() const noexcept
+    {
+        return address_;
+    }
+
+    /// Obtain the prefix length that was specified when the network object was created.
+    unsigned short prefix_length() const noexcept
+    {
+        return prefix_length_;
+    }
+
+    /// Obtain the netmask that was specified when the network object was created.
+    NETWORK_API address_v4 netmask() const noexcept;
+
+    /// Obtain an address object that represents the network address.
+    NETWORK_API address_v4 network() const noexcept;
+
+    /// Obtain an address object that represents the network's broadcast address.
+    NETWORK_API address_v4 broadcast() const noexcept;
+
+    /// Obtain an address range corresponding to the hosts in the network.
+    NETWORK_API address_v4_range hosts() const noexcept;
+
+    /// Obtain the true network address, omitting any host bits.
+    network_v4 canonical() const noexcept
+    {
+        return network_v4(network(), prefix_length());
+    }
+
+    /// Test if network is a valid host address.
+    bool is_host() const noexcept
+    {
+        return prefix_length_ == 32;
+    }
+
+    /// Test if a network is a real subnet of another network.
+    NETWORK_API bool is_subnet_of(const network_v4& other) const noexcept;
+
+    /// Test if an address belongs to the network.
+    bool contains(const address_v4& addr) const noexcept
+    {
+        return ((addr.addr_.s_addr ^ address_.addr_.s_addr) & mask_) == 0;
+    }
+
+    /// Get the network as an address in "address/prefix" form.
+    NETWORK_API std::string to_string() const;
+
+    /// Get the network as an address in "address/prefix" form.
+    NETWORK_API std::string to_string(std::error_code& ec) const;
+
+    /**
+     * Write the network in "address/prefix" form to [first, last) without
+     * allocating. No null terminator is written.
+     * @returns One past the last character written, or a null pointer if the
+     * range is too small.
+     */
+    NETWORK_API char* to_chars(char* first, char* last) const;
+
+    /// Compare two networks for equality.
+    friend bool operator==(const network_v4& a, const network_v4& b)
+    {
+        return a.address_ == b.address_ && a.prefix_length_ == b.prefix_length_;
+    }
+
+    /// Compare two networks for inequality.
+    friend bool operator!=(const network_v4& a, const network_v4& b)
+    {
+        return !(a == b);
+    }
+
+private:
+    address_v4 address_;
+    unsigned short prefix_length_;
+
+    // The netmask in network byte order.
+    uint_least32_t mask_;
+};
+
+/**
+ * Create an IPv4 network from an address and prefix length.
+ * @relates address_v4
+ */
+inline network_v4 make_network_v4(const address_v4& addr, unsigned short prefix_len)
+{
+    return network_v4(addr, prefix_len);
+}
+
+/**
+ * Create an IPv4 network from an address and netmask.
+ * @relates address_v4
+ */
+inline network_v4 make_network_v4(const address_v4& addr, const address_v4& mask)
+{
+    return network_v4(addr, mask);
+}
+
+/**
+ * Create an IPv4 network from a string containing IP address and prefix length,
+ * e.g. "10.0.0.0/8".
+ * @relates address_v4
+ */
+NETWORK_API network_v4 make_network_v4(const char* str);
+
+/**
+ * Create an IPv4 network from a string containing IP address and prefix length.
+ * @relates address_v4
+ */
+NETWORK_API network_v4 make_network_v4(const char* str, std::error_code& ec);
+
+/**
+ * Create an IPv4 network from a string containing IP address and prefix length.
+ * @relates address_v4
+ */
+NETWORK_API network_v4 make_network_v4(const std::string& str);
+
+/**
+ * Create an IPv4 network from a string containing IP address and prefix length.
+ * @relates address_v4
+ */
+NETWORK_API network_v4 make_network_v4(const std::string& str, std::error_code& ec);
+
+/**
+ * Create an IPv4 network from the "address/prefix" text in [first, last).
+ * @relates address_v4
+ */
+NETWORK_API network_v4 make_network_v4(const char* first, const char* last, std::error_code& ec);
+
+#if defined(NETWORK_HAS_STD_STRING_VIEW)
+/**
+ * Create an IPv4 network from a string containing IP address and prefix length.
+ * @relates address_v4
+ */
+NETWORK_API network_v4 make_network_v4(std::string_view str);
+
+/**
+ * Create an IPv4 network from a string containing IP address and prefix length.
+ * @relates address_v4
+ */
+NETWORK_API network_v4 make_network_v4(std::string_view str, std::error_code& ec);
+#endif // defined(NETWORK_HAS_STD_STRING_VIEW)
+
+/**
+ * Output a network as a string.
+ * Used to output a human-readable string for a specified network.
+ *
+ * @param os The output stream to which the string will be written.
+ *
+ * @param net The network to be written.
+ *
+ * @return The output stream.
+ *
+ * @relates NetLite::ip::address_v4
+ */
+template <typename Elem, typename Traits>
+std::basic_ostream<Elem, Traits>& operator<<(std::basic_ostream<Elem, Traits>& os, const network_v4& net)
+{
+    // The address, "/" and up to three digits, and the terminator.
+    char buffer[detail::address_formatter::max_v4_length + 5];
+    char* end = net.to_chars(buffer, buffer + sizeof(buffer) - 1);
+    if (end == 0)
+        return os;
+    *end = '\0';
+    return os << buffer;
+}
+
+} // namespace ip
+} // namespace NetLite
+
+#include "NetLite/ip/network_v4.ipp"
+
+#endif // END OF NETLITE_NETWORK_V4_HPP
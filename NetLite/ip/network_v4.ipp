@@ -0,0 +1,184 @@
+#ifndef NETLITE_NETWORK_V4_IPP
+#define NETLITE_NETWORK_V4_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstring>
+#include <stdexcept>
+#include "NetLite/socket_ops.hpp"
+#include "NetLite/ip/network_v4.hpp"
+
+namespace NetLite{
+namespace ip{
+
+network_v4::network_v4(const address_v4& addr, unsigned short prefix_len)
+    : address_(addr)
+    , prefix_length_(prefix_len)
+    , mask_(0)
+{
+    if (prefix_len > 32)
+    {
+        std::out_of_range ex("prefix length too large");
+        throw ex;
+    }
+    if (prefix_len != 0)
+        mask_ = socket_ops::host_to_network_long((0xFFFFFFFFul << (32 - prefix_len)) & 0xFFFFFFFF);
+}
+
+network_v4::network_v4(const address_v4& addr, const address_v4& mask)
+    : address_(addr)
+    , prefix_length_(0)
+    , mask_(mask.addr_.s_addr)
+{
+    const address_v4::uint_type mask_bits = mask.to_uint();
+    // The mask must be a run of ones followed by a run of zeros.
+    const address_v4::uint_type host_bits = ~mask_bits & 0xFFFFFFFF;
+    if ((host_bits & ((host_bits + 1) & 0xFFFFFFFF)) != 0)
+    {
+        std::invalid_argument ex("non-contiguous netmask");
+        throw ex;
+    }
+    for (address_v4::uint_type bits = mask_bits; bits & 0xFFFFFFFF; bits <<= 1)
+        ++prefix_length_;
+}
+
+address_v4 network_v4::netmask() const noexcept
+{
+    address_v4 mask;
+    mask.addr_.s_addr = mask_;
+    return mask;
+}
+
+address_v4 network_v4::network() const noexcept
+{
+    address_v4 net;
+    net.addr_.s_addr = address_.addr_.s_addr & mask_;
+    return net;
+}
+
+address_v4 network_v4::broadcast() const noexcept
+{
+    address_v4 last;
+    last.addr_.s_addr = address_.addr_.s_addr | ~mask_;
+    return last;
+}
+
+address_v4_range network_v4::hosts() const noexcept
+{
+    if (is_host())
+        return address_v4_range(address_, address_v4(address_.to_uint() + 1));
+    return address_v4_range(address_v4(network().to_uint() + 1), broadcast());
+}
+
+bool network_v4::is_subnet_of(const network_v4& other) const noexcept
+{
+    if (other.prefix_length_ >= prefix_length_)
+        return false; // Only real subsets are allowed.
+    return other.contains(address_);
+}
+
+std::string network_v4::to_string() const
+{
+    char buffer[detail::address_formatter::max_v4_length + 4];
+    char* end = to_chars(buffer, buffer + sizeof(buffer));
+    return std::string(buffer, end);
+}
+
+std::string network_v4::to_string(std::error_code& ec) const
+{
+    ec = std::error_code();
+    return to_string();
+}
+
+char* network_v4::to_chars(char* first, char* last) const
+{
+    char* p = address_.to_chars(first, last);
+    if (p == 0 || last - p < (prefix_length_ >= 10 ? 3 : 2))
+        return 0;
+    *p++ = '/';
+    if (prefix_length_ >= 10)
+        *p++ = static_cast<char>('0' + prefix_length_ / 10);
+    *p++ = static_cast<char>('0' + prefix_length_ % 10);
+    return p;
+}
+
+network_v4 make_network_v4(const char* str)
+{
+    std::error_code ec;
+    network_v4 net = make_network_v4(str, ec);
+    if (ec) throw ec;
+    return net;
+}
+
+network_v4 make_network_v4(const char* str, std::error_code& ec)
+{
+    using namespace std; // For strlen.
+    return make_network_v4(str, str + strlen(str), ec);
+}
+
+network_v4 make_network_v4(const std::string& str)
+{
+    std::error_code ec;
+    network_v4 net = make_network_v4(str.data(), str.data() + str.size(), ec);
+    if (ec) throw ec;
+    return net;
+}
+
+network_v4 make_network_v4(const std::string& str, std::error_code& ec)
+{
+    return make_network_v4(str.data(), str.data() + str.size(), ec);
+}
+
+network_v4 make_network_v4(const char* first, const char* last, std::error_code& ec)
+{
+    using namespace std; // For memchr.
+    const char* slash = static_cast<const char*>(memchr(first, '/', static_cast<std::size_t>(last - first)));
+    if (slash == 0 || slash + 1 == last || last - slash > 3)
+    {
+        ec = std::make_error_code(std::errc::invalid_argument);
+        return network_v4();
+    }
+
+    unsigned short prefix_len = 0;
+    for (const char* p = slash + 1; p != last; ++p)
+    {
+        if (*p < '0' || *p > '9')
+        {
+            ec = std::make_error_code(std::errc::invalid_argument);
+            return network_v4();
+        }
+        prefix_len = static_cast<unsigned short>(prefix_len * 10 + (*p - '0'));
+    }
+    if (prefix_len > 32)
+    {
+        ec = std::make_error_code(std::errc::invalid_argument);
+        return network_v4();
+    }
+
+    const address_v4 addr = make_address_v4(first, slash, ec);
+    if (ec)
+        return network_v4();
+    return network_v4(addr, prefix_len);
+}
+
+#if defined(NETWORK_HAS_STD_STRING_VIEW)
+network_v4 make_network_v4(std::string_view str)
+{
+    std::error_code ec;
+    network_v4 net = make_network_v4(str.data(), str.data() + str.size(), ec);
+    if (ec) throw ec;
+    return net;
+}
+
+network_v4 make_network_v4(std::string_view str, std::error_code& ec)
+{
+    return make_network_v4(str.data(), str.data() + str.size(), ec);
+}
+#endif // defined(NETWORK_HAS_STD_STRING_VIEW)
+
+} // namespace ip
+} // namespace NetLite
+
+#endif // END OF NETLITE_NETWORK_V4_IPP
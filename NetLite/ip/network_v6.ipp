@@ -0,0 +1,178 @@
+#ifndef NETLITE_NETWORK_V6_IPP
+#define NETLITE_NETWORK_V6_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstring>
+#include <stdexcept>
+#include "NetLite/ip/network_v6.hpp"
+
+namespace NetLite{
+namespace ip{
+
+network_v6::network_v6(const address_v6& addr, unsigned short prefix_len)
+    : address_(addr)
+    , prefix_length_(prefix_len)
+{
+    if (prefix_len > 128)
+    {
+        std::out_of_range ex("prefix length too large");
+        throw ex;
+    }
+
+    using namespace std; // For memcpy and memset.
+    unsigned char mask[16];
+    memset(mask, 0, sizeof(mask));
+    for (unsigned short i = 0; i < prefix_len / 8; ++i)
+        mask[i] = 0xFF;
+    if (prefix_len % 8 != 0)
+        mask[prefix_len / 8] = static_cast<unsigned char>(0xFF << (8 - prefix_len % 8));
+    memcpy(mask_, mask, 16);
+}
+
+address_v6 network_v6::network() const noexcept
+{
+    using namespace std; // For memcpy.
+    uint64_t words[2];
+    memcpy(words, address_.addr_.s6_addr, 16);
+    words[0] &= mask_[0];
+    words[1] &= mask_[1];
+    address_v6 net;
+    memcpy(net.addr_.s6_addr, words, 16);
+    return net;
+}
+
+address_v6_range network_v6::hosts() const noexcept
+{
+    if (is_host())
+    {
+        address_v6_range::iterator last(address_);
+        return address_v6_range(address_v6_range::iterator(address_), ++last);
+    }
+
+    using namespace std; // For memcpy.
+    uint64_t words[2];
+    memcpy(words, address_.addr_.s6_addr, 16);
+    words[0] |= ~mask_[0];
+    words[1] |= ~mask_[1];
+    address_v6 broadcast;
+    memcpy(broadcast.addr_.s6_addr, words, 16);
+    address_v6_range::iterator last(broadcast);
+    return address_v6_range(address_v6_range::iterator(network()), ++last);
+}
+
+bool network_v6::is_subnet_of(const network_v6& other) const noexcept
+{
+    if (other.prefix_length_ >= prefix_length_)
+        return false; // Only real subsets are allowed.
+    return other.contains(address_);
+}
+
+std::string network_v6::to_string() const
+{
+    char buffer[max_addr_v6_str_len + 4];
+    char* end = to_chars(buffer, buffer + sizeof(buffer));
+    return std::string(buffer, end);
+}
+
+std::string network_v6::to_string(std::error_code& ec) const
+{
+    ec = std::error_code();
+    return to_string();
+}
+
+char* network_v6::to_chars(char* first, char* last) const
+{
+    const int digits = prefix_length_ >= 100 ? 3 : prefix_length_ >= 10 ? 2 : 1;
+    char* p = address_.to_chars(first, last);
+    if (p == 0 || last - p < digits + 1)
+        return 0;
+    *p++ = '/';
+    if (digits == 3)
+        *p++ = static_cast<char>('0' + prefix_length_ / 100);
+    if (digits >= 2)
+        *p++ = static_cast<char>('0' + prefix_length_ / 10 % 10);
+    *p++ = static_cast<char>('0' + prefix_length_ % 10);
+    return p;
+}
+
+network_v6 make_network_v6(const char* str)
+{
+    std::error_code ec;
+    network_v6 net = make_network_v6(str, ec);
+    if (ec) throw ec;
+    return net;
+}
+
+network_v6 make_network_v6(const char* str, std::error_code& ec)
+{
+    using namespace std; // For strlen.
+    return make_network_v6(str, str + strlen(str), ec);
+}
+
+network_v6 make_network_v6(const std::string& str)
+{
+    std::error_code ec;
+    network_v6 net = make_network_v6(str.data(), str.data() + str.size(), ec);
+    if (ec) throw ec;
+    return net;
+}
+
+network_v6 make_network_v6(const std::string& str, std::error_code& ec)
+{
+    return make_network_v6(str.data(), str.data() + str.size(), ec);
+}
+
+network_v6 make_network_v6(const char* first, const char* last, std::error_code& ec)
+{
+    using namespace std; // For memchr.
+    const char* slash = static_cast<const char*>(memchr(first, '/', static_cast<std::size_t>(last - first)));
+    if (slash == 0 || slash + 1 == last || last - slash > 4)
+    {
+        ec = std::make_error_code(std::errc::invalid_argument);
+        return network_v6();
+    }
+
+    unsigned short prefix_len = 0;
+    for (const char* p = slash + 1; p != last; ++p)
+    {
+        if (*p < '0' || *p > '9')
+        {
+            ec = std::make_error_code(std::errc::invalid_argument);
+            return network_v6();
+        }
+        prefix_len = static_cast<unsigned short>(prefix_len * 10 + (*p - '0'));
+    }
+    if (prefix_len > 128)
+    {
+        ec = std::make_error_code(std::errc::invalid_argument);
+        return network_v6();
+    }
+
+    const address_v6 addr = make_address_v6(first, slash, ec);
+    if (ec)
+        return network_v6();
+    return network_v6(addr, prefix_len);
+}
+
+#if defined(NETWORK_HAS_STD_STRING_VIEW)
+network_v6 make_network_v6(std::string_view str)
+{
+    std::error_code ec;
+    network_v6 net = make_network_v6(str.data(), str.data() + str.size(), ec);
+    if (ec) throw ec;
+    return net;
+}
+
+network_v6 make_network_v6(std::string_view str, std::error_code& ec)
+{
+    return make_network_v6(str.data(), str.data() + str.size(), ec);
+}
+#endif // defined(NETWORK_HAS_STD_STRING_VIEW)
+
+} // namespace ip
+} // namespace NetLite
+
+#endif // END OF NETLITE_NETWORK_V6_IPP
@@ -0,0 +1,300 @@
+#ifndef NETLITE_PREFIX_TABLE_HPP
+#define NETLITE_PREFIX_TABLE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <vector>
+#include "NetLite/config.hpp"
+#include "NetLite/detail/multibit_trie.hpp"
+#include "NetLite/ip/address.hpp"
+#include "NetLite/ip/address_v4.hpp"
+#include "NetLite/ip/address_v6.hpp"
+#include "NetLite/ip/network_v4.hpp"
+#include "NetLite/ip/network_v6.hpp"
+
+namespace NetLite{
+namespace ip{
+
+/**
+ * Maps IPv4 and IPv6 networks to values and finds the value of the longest
+ * prefix containing an address.
+ *
+ * Each family is stored in a leaf-pushed multibit trie with a 16-bit first
+ * level followed by 8-bit levels, so an IPv4 lookup reads at most three table
+ * slots and never backtracks. The batched find() overloads walk a group of
+ * addresses level by level and prefetch the next slot of every address in the
+ * group before reading any of them, hiding most of the cache misses of a large
+ * table.
+ *
+ * Updates cost time proportional to the address space a prefix covers, and the
+ * tables are not shrunk when prefixes are erased; the structure is meant to be
+ * built once and then queried many times.
+ *
+ * @par Example
+ * @code
+ * NetLite::ip::prefix_table<int> acl;
+ * acl.insert(NetLite::ip::make_network_v4("10.0.0.0/8"), 1);
+ * acl.insert(NetLite::ip::make_network_v4("10.1.0.0/16"), 2);
+ * const int* action = acl.find(socket.remote_endpoint().address());
+ * if (action != nullptr && *action == 2)
+ *     socket.close();
+ * @endcode
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Safe for concurrent find() calls, unsafe while the
+ * table is being modified.
+ */
+template <typename T>
+class prefix_table
+{
+public:
+    /// The type of the values held by the table.
+    typedef T value_type;
+
+    /// Construct an empty table.
+    prefix_table()
+    {
+    }
+
+    /// Associate a value with an IPv4 network, replacing any previous value.
+    void insert(const network_v4& net, const T& value)
+    {
+        insert(v4_, net.network().to_bytes().data(), net.prefix_length(), value);
+    }
+
+    /// Associate a value with an IPv6 network, replacing any previous value.
+    void insert(const network_v6& net, const T& value)
+    {
+        insert(v6_, net.network().to_bytes().data(), net.prefix_length(), value);
+    }
+
+    /**
+     * Remove an IPv4 network. Addresses it contained fall back to the next
+     * longest prefix.
+     * @returns true if the network was in the table.
+     */
+    bool erase(const network_v4& net)
+    {
+        return erase(v4_, net.network().to_bytes().data(), net.prefix_length());
+    }
+
+    /**
+     * Remove an IPv6 network. Addresses it contained fall back to the next
+     * longest prefix.
+     * @returns true if the network was in the table.
+     */
+    bool erase(const network_v6& net)
+    {
+        return erase(v6_, net.network().to_bytes().data(), net.prefix_length());
+    }
+
+    /// Find the value of the longest IPv4 prefix containing the address.
+    const T* find(const address_v4& addr) const
+    {
+        return value_of(v4_.trie.lookup(addr.to_bytes().data()));
+    }
+
+    /// Find the value of the longest IPv6 prefix containing the address.
+    const T* find(const address_v6& addr) const
+    {
+        return value_of(v6_.trie.lookup(addr.to_bytes().data()));
+    }
+
+    /// Find the value of the longest prefix containing the address.
+    const T* find(const address& addr) const
+    {
+        return addr.is_v4() ? find(addr.to_v4()) : find(addr.to_v6());
+    }
+
+    /**
+     * Find the values of count IPv4 addresses at once. results[i] is set to
+     * the value of the longest prefix containing addrs[i], or to a null
+     * pointer when there is none.
+     */
+    void find(const address_v4* addrs, std::size_t count, const T** results) const
+    {
+        find_batch(v4_, addrs, count, results);
+    }
+
+    /**
+     * Find the values of count IPv6 addresses at once. results[i] is set to
+     * the value of the longest prefix containing addrs[i], or to a null
+     * pointer when there is none.
+     */
+    void find(const address_v6* addrs, std::size_t count, const T** results) const
+    {
+        find_batch(v6_, addrs, count, results);
+    }
+
+    /// Get the number of networks in the table.
+    std::size_t size() const
+    {
+        return v4_.prefixes.size() + v6_.prefixes.size();
+    }
+
+    /// Determine whether the table is empty.
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /// Remove all networks.
+    void clear()
+    {
+        v4_.trie.clear();
+        v4_.prefixes.clear();
+        v6_.trie.clear();
+        v6_.prefixes.clear();
+        values_.clear();
+        free_values_.clear();
+    }
+
+    /// Get the number of bytes used by the lookup tables.
+    std::size_t memory_usage() const
+    {
+        return v4_.trie.memory_usage() + v6_.trie.memory_usage();
+    }
+
+private:
+    template <std::size_t KeyBytes>
+    struct family
+    {
+        // The masked network bytes followed by the prefix length.
+        typedef std::array<unsigned char, KeyBytes + 1> key_type;
+
+        detail::multibit_trie<KeyBytes> trie;
+
+        // Every network in the table and the index of its value.
+        std::map<key_type, uint32_t> prefixes;
+
+        static key_type make_key(const unsigned char* bytes, unsigned int length)
+        {
+            key_type key;
+            for (std::size_t i = 0; i < KeyBytes; ++i)
+                key[i] = bytes[i];
+            key[KeyBytes] = static_cast<unsigned char>(length);
+            return key;
+        }
+
+        static void mask(key_type& key, unsigned int length)
+        {
+            for (std::size_t i = 0; i < KeyBytes; ++i)
+            {
+                const unsigned int bit = static_cast<unsigned int>(i) * 8;
+                if (length <= bit)
+                    key[i] = 0;
+                else if (length < bit + 8)
+                    key[i] &= static_cast<unsigned char>(0xFF << (bit + 8 - length));
+            }
+            key[KeyBytes] = static_cast<unsigned char>(length);
+        }
+    };
+
+    template <std::size_t KeyBytes>
+    void insert(family<KeyBytes>& f, const unsigned char* bytes,
+        unsigned int length, const T& value)
+    {
+        const typename family<KeyBytes>::key_type key = family<KeyBytes>::make_key(bytes, length);
+        typename std::map<typename family<KeyBytes>::key_type, uint32_t>::iterator it = f.prefixes.find(key);
+        if (it != f.prefixes.end())
+        {
+            values_[it->second] = value;
+            return;
+        }
+
+        uint32_t index;
+        if (!free_values_.empty())
+        {
+            index = free_values_.back();
+            values_[index] = value;
+            free_values_.pop_back();
+        }
+        else
+        {
+            if (values_.size() >= detail::multibit_trie<KeyBytes>::max_value)
+            {
+                std::length_error ex("prefix_table too large");
+                throw ex;
+            }
+            index = static_cast<uint32_t>(values_.size());
+            values_.push_back(value);
+        }
+        f.prefixes.insert(std::make_pair(key, index));
+        f.trie.assign(bytes, length, index + 1);
+    }
+
+    template <std::size_t KeyBytes>
+    bool erase(family<KeyBytes>& f, const unsigned char* bytes, unsigned int length)
+    {
+        typename family<KeyBytes>::key_type key = family<KeyBytes>::make_key(bytes, length);
+        typename std::map<typename family<KeyBytes>::key_type, uint32_t>::iterator it = f.prefixes.find(key);
+        if (it == f.prefixes.end())
+            return false;
+        free_values_.push_back(it->second);
+        f.prefixes.erase(it);
+
+        // Hand the slots over to the longest network still covering this one.
+        uint32_t cover_value = 0;
+        unsigned int cover_length = 0;
+        for (unsigned int l = length; l-- > 0;)
+        {
+            family<KeyBytes>::mask(key, l);
+            it = f.prefixes.find(key);
+            if (it != f.prefixes.end())
+            {
+                cover_value = it->second + 1;
+                cover_length = l;
+                break;
+            }
+        }
+        f.trie.reassign(bytes, length, cover_value, cover_length);
+        return true;
+    }
+
+    template <std::size_t KeyBytes, typename Address>
+    void find_batch(const family<KeyBytes>& f, const Address* addrs,
+        std::size_t count, const T** results) const
+    {
+        enum { group_size = 64 };
+        unsigned char keys[group_size * KeyBytes];
+        uint32_t found[group_size];
+        for (std::size_t base = 0; base < count; base += group_size)
+        {
+            const std::size_t n = (count - base < group_size) ? count - base : static_cast<std::size_t>(group_size);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const typename Address::bytes_type bytes = addrs[base + i].to_bytes();
+                std::memcpy(keys + i * KeyBytes, bytes.data(), KeyBytes);
+            }
+            f.trie.lookup(keys, n, found);
+            for (std::size_t i = 0; i < n; ++i)
+                results[base + i] = value_of(found[i]);
+        }
+    }
+
+    const T* value_of(uint32_t found) const
+    {
+        return found != 0 ? &values_[found - 1] : 0;
+    }
+
+    family<4> v4_;
+    family<16> v6_;
+    std::vector<T> values_;
+
+    // Indices in values_ released by erase() and reused by insert().
+    std::vector<uint32_t> free_values_;
+};
+
+} // namespace ip
+} // namespace NetLite
+
+#endif // END OF NETLITE_PREFIX_TABLE_HPP
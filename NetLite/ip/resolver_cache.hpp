@@ -0,0 +1,167 @@
+#ifndef NETLITE_RESOLVER_CACHE_HPP
+#define NETLITE_RESOLVER_CACHE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <array>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "NetLite/config.hpp"
+#include "NetLite/net_error_code.hpp"
+#include "NetLite/socket_types.hpp"
+#include "NetLite/ip/endpoint.hpp"
+
+namespace NetLite{
+namespace ip{
+
+/**
+ * In-process cache in front of getaddrinfo.
+ *
+ * Results are keyed by the host name, the service name and the hints passed
+ * to getaddrinfo (flags, family, socket type and protocol). Successful lookups
+ * are kept for the positive TTL, failed lookups that are not transient
+ * (e.g. host not found) are kept for the negative TTL. The table is split into
+ * shards guarded by reader/writer locks, so concurrent cache hits do not
+ * contend with each other.
+ *
+ * Concurrent misses for the same key are coalesced: only the first caller
+ * runs getaddrinfo, the others wait for its outcome.
+ *
+ * @par Example
+ * @code
+ * NetLite::ip::resolver_cache cache;
+ * std::error_code ec;
+ * NetLite::ip::resolver_cache::results_type results =
+ *     cache.resolve("www.example.com", "80", ec);
+ * if (!ec)
+ * {
+ *     for (const NetLite::ip::endpoint& ep : *results)
+ *         std::cout << ep.to_string() << std::endl;
+ * }
+ * @endcode
+ */
+class resolver_cache
+{
+public:
+    /// The clock used to expire cache entries.
+    typedef std::chrono::steady_clock clock_type;
+
+    /// The duration type used for the TTLs.
+    typedef clock_type::duration duration_type;
+
+    /// The resolved endpoints, shared between the cache and its callers.
+    typedef std::shared_ptr<const std::vector<ip::endpoint> > results_type;
+
+    /// Construct a cache with the given positive and negative TTLs.
+    NETWORK_API explicit resolver_cache(
+        duration_type positive_ttl = std::chrono::seconds(60),
+        duration_type negative_ttl = std::chrono::seconds(5));
+
+    /// Resolve a host and service with unspecified hints.
+    NETWORK_API results_type resolve(const char* host, const char* service);
+
+    /// Resolve a host and service with unspecified hints.
+    NETWORK_API results_type resolve(const char* host, const char* service,
+        std::error_code& ec);
+
+    /// Resolve a host and service with the given getaddrinfo hints.
+    NETWORK_API results_type resolve(const char* host, const char* service,
+        const addrinfo_type& hints);
+
+    /**
+     * Resolve a host and service with the given getaddrinfo hints.
+     *
+     * Only the ai_flags, ai_family, ai_socktype and ai_protocol members of
+     * the hints are used, and they are part of the cache key.
+     *
+     * @param ec Set to indicate what error occurred, if any. A cached failure
+     * reports the same error as the lookup that produced it.
+     *
+     * @returns The resolved IPv4 and IPv6 endpoints, in the order returned by
+     * getaddrinfo with duplicates removed. Null on failure.
+     */
+    NETWORK_API results_type resolve(const char* host, const char* service,
+        const addrinfo_type& hints, std::error_code& ec);
+
+    /// Remove the entry for a key, forcing the next lookup to query again.
+    NETWORK_API void erase(const char* host, const char* service,
+        const addrinfo_type& hints);
+
+    /// Remove all entries.
+    NETWORK_API void clear();
+
+    /// Remove the expired entries and return how many were removed.
+    NETWORK_API std::size_t purge_expired();
+
+    /// Get the number of entries, including the expired ones not yet purged.
+    NETWORK_API std::size_t size() const;
+
+    /// Get the TTL of successful lookups.
+    NETWORK_API duration_type positive_ttl() const
+    {
+        return _positive_ttl;
+    }
+
+    /// Get the TTL of failed lookups.
+    NETWORK_API duration_type negative_ttl() const
+    {
+        return _negative_ttl;
+    }
+
+private:
+    // The outcome of a single getaddrinfo call.
+    struct outcome
+    {
+        results_type results;
+        std::error_code error;
+    };
+
+    // A cached outcome, or a lookup in progress when pending is valid.
+    struct entry
+    {
+        outcome value;
+        clock_type::time_point expiry;
+        std::shared_future<outcome> pending;
+    };
+
+    // Number of independently locked shards. Must be a power of two.
+    enum { shard_count = 16 };
+
+    struct shard
+    {
+        mutable std::shared_timed_mutex mutex;
+        std::unordered_map<std::string, entry> entries;
+    };
+
+    // Build the key for a host, service and hints.
+    NETWORK_API static std::string make_key(const char* host,
+        const char* service, const addrinfo_type& hints);
+
+    // Select the shard for a key.
+    NETWORK_API shard& shard_for(const std::string& key);
+
+    // Run getaddrinfo and convert its results.
+    NETWORK_API static outcome lookup(const char* host, const char* service,
+        const addrinfo_type& hints);
+
+    // Whether a failed lookup may be kept for the negative TTL.
+    NETWORK_API static bool is_cacheable_failure(const std::error_code& ec);
+
+    std::array<shard, shard_count> _shards;
+    duration_type _positive_ttl;
+    duration_type _negative_ttl;
+};
+
+} // namespace ip
+} // namespace NetLite
+
+# include "NetLite/ip/resolver_cache.ipp"
+
+#endif // END OF NETLITE_RESOLVER_CACHE_HPP
@@ -0,0 +1,260 @@
+#ifndef NETLITE_RESOLVER_CACHE_IPP
+#define NETLITE_RESOLVER_CACHE_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include "NetLite/net_error_code.hpp"
+#include "NetLite/socket_ops.hpp"
+#include "NetLite/ip/resolver_cache.hpp"
+
+namespace NetLite{
+namespace ip{
+
+resolver_cache::resolver_cache(duration_type positive_ttl, duration_type negative_ttl)
+    : _shards()
+    , _positive_ttl(positive_ttl)
+    , _negative_ttl(negative_ttl)
+{
+}
+
+resolver_cache::results_type resolver_cache::resolve(const char* host, const char* service)
+{
+    std::error_code ec;
+    results_type results = resolve(host, service, ec);
+    throw_if(ec, "resolve");
+    return results;
+}
+
+resolver_cache::results_type resolver_cache::resolve(const char* host, const char* service, std::error_code& ec)
+{
+    addrinfo_type hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = NET_OS_DEF(AF_UNSPEC);
+    return resolve(host, service, hints, ec);
+}
+
+resolver_cache::results_type resolver_cache::resolve(const char* host, const char* service, const addrinfo_type& hints)
+{
+    std::error_code ec;
+    results_type results = resolve(host, service, hints, ec);
+    throw_if(ec, "resolve");
+    return results;
+}
+
+resolver_cache::results_type resolver_cache::resolve(const char* host, const char* service, const addrinfo_type& hints, std::error_code& ec)
+{
+    const std::string key = make_key(host, service, hints);
+    shard& s = shard_for(key);
+
+    // Fast path: a fresh entry under the shared lock.
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(s.mutex);
+        auto iter = s.entries.find(key);
+        if (iter != s.entries.end() && !iter->second.pending.valid()
+            && clock_type::now() < iter->second.expiry)
+        {
+            ec = iter->second.value.error;
+            return iter->second.value.results;
+        }
+    }
+
+    std::promise<outcome> promise;
+    std::shared_future<outcome> pending;
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(s.mutex);
+        entry& e = s.entries[key];
+        if (e.pending.valid())
+        {
+            // Another thread is already resolving this key, wait for it.
+            pending = e.pending;
+        }
+        else if (clock_type::now() < e.expiry)
+        {
+            ec = e.value.error;
+            return e.value.results;
+        }
+        else
+        {
+            e.pending = promise.get_future().share();
+        }
+    }
+
+    if (pending.valid())
+    {
+        const outcome& result = pending.get();
+        ec = result.error;
+        return result.results;
+    }
+
+    outcome result;
+    try
+    {
+        result = lookup(host, service, hints);
+    }
+    catch (...)
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(s.mutex);
+        s.entries.erase(key);
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(s.mutex);
+        entry& e = s.entries[key];
+        e.pending = std::shared_future<outcome>();
+        if (!result.error || is_cacheable_failure(result.error))
+        {
+            e.value = result;
+            e.expiry = clock_type::now() + (result.error ? _negative_ttl : _positive_ttl);
+        }
+        else
+        {
+            s.entries.erase(key);
+        }
+    }
+    promise.set_value(result);
+
+    ec = result.error;
+    return result.results;
+}
+
+void resolver_cache::erase(const char* host, const char* service, const addrinfo_type& hints)
+{
+    const std::string key = make_key(host, service, hints);
+    shard& s = shard_for(key);
+    std::unique_lock<std::shared_timed_mutex> lock(s.mutex);
+    auto iter = s.entries.find(key);
+    // An in-flight lookup owns its entry until it completes.
+    if (iter != s.entries.end() && !iter->second.pending.valid())
+        s.entries.erase(iter);
+}
+
+void resolver_cache::clear()
+{
+    for (shard& s : _shards)
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(s.mutex);
+        for (auto iter = s.entries.begin(); iter != s.entries.end();)
+        {
+            if (iter->second.pending.valid())
+                ++iter;
+            else
+                iter = s.entries.erase(iter);
+        }
+    }
+}
+
+std::size_t resolver_cache::purge_expired()
+{
+    std::size_t removed = 0;
+    const clock_type::time_point now = clock_type::now();
+    for (shard& s : _shards)
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(s.mutex);
+        for (auto iter = s.entries.begin(); iter != s.entries.end();)
+        {
+            if (!iter->second.pending.valid() && !(now < iter->second.expiry))
+            {
+                iter = s.entries.erase(iter);
+                ++removed;
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+    }
+    return removed;
+}
+
+std::size_t resolver_cache::size() const
+{
+    std::size_t total = 0;
+    for (const shard& s : _shards)
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(s.mutex);
+        total += s.entries.size();
+    }
+    return total;
+}
+
+std::string resolver_cache::make_key(const char* host, const char* service, const addrinfo_type& hints)
+{
+    const int fields[4] = { hints.ai_flags, hints.ai_family, hints.ai_socktype, hints.ai_protocol };
+    std::string key;
+    key.reserve(64);
+    if (host) key.append(host);
+    key.push_back('\0');
+    if (service) key.append(service);
+    key.push_back('\0');
+    key.append(reinterpret_cast<const char*>(fields), sizeof(fields));
+    return key;
+}
+
+resolver_cache::shard& resolver_cache::shard_for(const std::string& key)
+{
+    return _shards[std::hash<std::string>()(key) & (shard_count - 1)];
+}
+
+resolver_cache::outcome resolver_cache::lookup(const char* host, const char* service, const addrinfo_type& hints)
+{
+    addrinfo_type query;
+    std::memset(&query, 0, sizeof(query));
+    query.ai_flags = hints.ai_flags;
+    query.ai_family = hints.ai_family;
+    query.ai_socktype = hints.ai_socktype;
+    query.ai_protocol = hints.ai_protocol;
+
+    outcome result;
+    addrinfo_type* address_info = nullptr;
+    socket_ops::getaddrinfo(host, service, query, &address_info, result.error);
+    if (result.error)
+        return result;
+
+    std::shared_ptr<std::vector<ip::endpoint> > endpoints = std::make_shared<std::vector<ip::endpoint> >();
+    for (addrinfo_type* ai = address_info; ai; ai = ai->ai_next)
+    {
+        if (ai->ai_family != NET_OS_DEF(AF_INET) && ai->ai_family != NET_OS_DEF(AF_INET6))
+            continue;
+        ip::endpoint ep;
+        std::size_t addrlen = ai->ai_addrlen;
+        if (addrlen > ep.capacity())
+            addrlen = ep.capacity();
+        std::memcpy(ep.data(), ai->ai_addr, addrlen);
+
+        // Without a socket type getaddrinfo repeats each address per protocol.
+        bool duplicate = false;
+        for (const ip::endpoint& existing : *endpoints)
+        {
+            if (existing == ep)
+            {
+                duplicate = true;
+                break;
+            }
+        }
+        if (!duplicate)
+            endpoints->push_back(ep);
+    }
+    socket_ops::freeaddrinfo(address_info);
+
+    result.results = endpoints;
+    return result;
+}
+
+bool resolver_cache::is_cacheable_failure(const std::error_code& ec)
+{
+    // Temporary failures and resource exhaustion are worth retrying at once.
+    return ec != std::error_code(NET_NETDB_ERROR(TRY_AGAIN), std::system_category())
+        && ec != std::make_error_code(std::errc::not_enough_memory);
+}
+
+} // namespace ip
+} // namespace NetLite
+
+#endif // END OF NETLITE_RESOLVER_CACHE_IPP
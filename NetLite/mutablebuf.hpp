@@ -81,6 +81,31 @@ public:
         assign(reinterpret_cast<uint8_t*>(inData), length, need_del);
     }
 
+    /// Construct a buffer that owns a memory range through a shared pointer,
+    /// which may carry its own deleter.
+    basic_mutablebuf(const _Ptr& holder, std::size_t length)
+        : memory_holder(holder)
+        , memory_length(length)
+    {
+    }
+
+    /// Construct a buffer that shares the memory of another buffer but only
+    /// covers its first length bytes.
+    basic_mutablebuf(const _Myt& other, std::size_t length)
+        : memory_holder(other.memory_holder)
+        , memory_length(length < other.memory_length ? length : other.memory_length)
+    {
+    }
+
+    /// Construct a buffer that shares the memory of another buffer but only
+    /// covers up to length bytes starting at offset, which must not be past
+    /// the end of the other buffer.
+    basic_mutablebuf(const _Myt& other, std::size_t offset, std::size_t length)
+        : memory_holder(other.memory_holder, other.memory_holder.get() + offset)
+        , memory_length(length < other.memory_length - offset ? length : other.memory_length - offset)
+    {
+    }
+
     /// Assignment operator
     basic_mutablebuf& operator= (const _Myt& other)
     {
@@ -364,6 +389,24 @@ struct make_buffer<mutablebuf, SrcT>
     }
 };
 
+template<>
+struct make_buffer<mutablebuf, const mutablebuf&>
+{
+    static mutablebuf make(const mutablebuf& buffer)
+    {
+        return buffer;
+    }
+};
+
+template<>
+struct make_buffer<mutablebuf, mutablebuf&>
+{
+    static mutablebuf make(mutablebuf& buffer)
+    {
+        return buffer;
+    }
+};
+
 template<typename SrcT>
 struct make_buffer<constbuf, SrcT>
 {
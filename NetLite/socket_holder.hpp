@@ -0,0 +1,131 @@
+#ifndef NETLITE_SOCKET_HOLDER_HPP
+#define NETLITE_SOCKET_HOLDER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <memory>
+#include "NetLite/config.hpp"
+#include "NetLite/socket_types.hpp"
+
+namespace NetLite{
+
+/**
+ * Ownership policies for the descriptor of a basic_socket.
+ *
+ * A holder only stores the descriptor; basic_socket closes it when the last
+ * owner goes away. The holder's copy and move operations decide whether the
+ * socket type is copyable.
+ */
+
+/**
+ * Shares one heap-allocated descriptor between all copies of a socket. The
+ * descriptor is closed when the last copy is destroyed.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+class shared_socket_holder
+{
+public:
+    /// Construct a holder that holds no descriptor.
+    shared_socket_holder() noexcept
+    {
+    }
+
+    /// Take ownership of a descriptor.
+    void hold(socket_type native_socket)
+    {
+        socket_ = std::make_shared<socket_type>(native_socket);
+    }
+
+    /// Get the held descriptor, or invalid_socket.
+    socket_type get() const noexcept
+    {
+        return socket_ ? *socket_ : invalid_socket;
+    }
+
+    /// Determine whether this is the only holder of a descriptor.
+    bool is_last_owner() const noexcept
+    {
+        return socket_ && socket_.use_count() == 1;
+    }
+
+    /// Drop this holder's reference to the descriptor.
+    void reset() noexcept
+    {
+        socket_.reset();
+    }
+
+private:
+    std::shared_ptr<socket_type> socket_;
+};
+
+/**
+ * Stores the descriptor inline. Holding a descriptor allocates nothing, and
+ * the holder is move-only, so exactly one socket object owns the descriptor.
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+class unique_socket_holder
+{
+public:
+    /// Construct a holder that holds no descriptor.
+    unique_socket_holder() noexcept
+        : socket_(invalid_socket)
+    {
+    }
+
+    /// Move-construct a holder, leaving the other one empty.
+    unique_socket_holder(unique_socket_holder&& other) noexcept
+        : socket_(other.socket_)
+    {
+        other.socket_ = invalid_socket;
+    }
+
+    /// Move-assign a holder, leaving the other one empty.
+    unique_socket_holder& operator=(unique_socket_holder&& other) noexcept
+    {
+        socket_ = other.socket_;
+        other.socket_ = invalid_socket;
+        return *this;
+    }
+
+    unique_socket_holder(const unique_socket_holder&) = delete;
+    unique_socket_holder& operator=(const unique_socket_holder&) = delete;
+
+    /// Take ownership of a descriptor.
+    void hold(socket_type native_socket) noexcept
+    {
+        socket_ = native_socket;
+    }
+
+    /// Get the held descriptor, or invalid_socket.
+    socket_type get() const noexcept
+    {
+        return socket_;
+    }
+
+    /// Determine whether this is the only holder of a descriptor.
+    bool is_last_owner() const noexcept
+    {
+        return socket_ != invalid_socket;
+    }
+
+    /// Forget the descriptor without closing it.
+    void reset() noexcept
+    {
+        socket_ = invalid_socket;
+    }
+
+private:
+    socket_type socket_;
+};
+
+} // namespace NetLite
+
+#endif // END OF NETLITE_SOCKET_HOLDER_HPP
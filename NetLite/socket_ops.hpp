@@ -45,6 +45,16 @@ enum
 
 typedef unsigned char state_type;
 
+// Flags for the descriptor returned by accept.
+enum
+{
+  // The accepted socket is non-blocking.
+  accept_non_blocking = 1,
+
+  // The accepted descriptor is closed on exec.
+  accept_close_on_exec = 2
+};
+
 struct noop_deleter { void operator()(void*) {} };
 typedef std::shared_ptr<void> shared_cancel_token_type;
 typedef std::weak_ptr<void> weak_cancel_token_type;
@@ -53,6 +63,9 @@ typedef std::weak_ptr<void> weak_cancel_token_type;
 NETWORK_API socket_type accept(socket_type s, socket_addr_type* addr,
     std::size_t* addrlen, std::error_code& ec);
 
+NETWORK_API socket_type accept(socket_type s, socket_addr_type* addr,
+    std::size_t* addrlen, int flags, std::error_code& ec);
+
 NETWORK_API socket_type sync_accept(socket_type s,
     state_type state, socket_addr_type* addr,
     std::size_t* addrlen, std::error_code& ec);
@@ -92,6 +105,10 @@ NETWORK_API bool sockatmark(socket_type s, std::error_code& ec);
 
 NETWORK_API size_t available(socket_type s, std::error_code& ec);
 
+// The bytes in a TCP socket's send queue: sent but not acknowledged, plus
+// written but not yet sent. Linux only.
+NETWORK_API size_t send_queue_size(socket_type s, std::error_code& ec);
+
 NETWORK_API int listen(socket_type s,
     int backlog, std::error_code& ec);
 
@@ -165,6 +182,10 @@ NETWORK_API bool non_blocking_sendto(socket_type s,
     const socket_addr_type* addr, std::size_t addrlen,
     std::error_code& ec, size_t& bytes_transferred);
 
+NETWORK_API signed_size_type sync_connect_and_send(socket_type s,
+    const buf* bufs, size_t count, const socket_addr_type* addr,
+    std::size_t addrlen, std::error_code& ec);
+
 NETWORK_API socket_type socket(int af, int type, int protocol,
     std::error_code& ec);
 
@@ -210,6 +231,13 @@ NETWORK_API int gethostname(char* name, int namelen, std::error_code& ec);
 
 NETWORK_API struct hostent* gethostbyname(const char* name, std::error_code& ec);
 
+// Resolve a host name into at most out_count addresses of the given family
+// (AF_UNSPEC for both). Returns the number of addresses found, which is more
+// than out_count when out was too small; only the first out_count are
+// written. A host with no address sets ec to HOST_NOT_FOUND and returns 0.
+NETWORK_API std::size_t resolve(const char* hostname, int af,
+    sockaddr_storage_type* out, std::size_t out_count, std::error_code& ec);
+
 NETWORK_API bool resolve(const char* hostname, struct sockaddr_in6 *out, std::error_code& ec);
 NETWORK_API bool resolve(const char* hostname, struct sockaddr_in *out, std::error_code& ec);
 
@@ -68,8 +68,27 @@ inline socket_type call_accept(SockLenType msghdr::*,
   return result;
 }
 
+#if defined(__linux__) && defined(SOCK_NONBLOCK) && defined(SOCK_CLOEXEC)
+template <typename SockLenType>
+inline socket_type call_accept4(SockLenType msghdr::*,
+    socket_type s, socket_addr_type* addr, std::size_t* addrlen, int flags)
+{
+  SockLenType tmp_addrlen = addrlen ? (SockLenType)*addrlen : 0;
+  socket_type result = ::accept4(s, addr, addrlen ? &tmp_addrlen : 0, flags);
+  if (addrlen)
+    *addrlen = (std::size_t)tmp_addrlen;
+  return result;
+}
+#endif // defined(__linux__) && defined(SOCK_NONBLOCK) && defined(SOCK_CLOEXEC)
+
 socket_type accept(socket_type s, socket_addr_type* addr,
     std::size_t* addrlen, std::error_code& ec)
+{
+  return accept(s, addr, addrlen, 0, ec);
+}
+
+socket_type accept(socket_type s, socket_addr_type* addr,
+    std::size_t* addrlen, int flags, std::error_code& ec)
 {
   if (s == invalid_socket)
   {
@@ -79,11 +98,56 @@ socket_type accept(socket_type s, socket_addr_type* addr,
 
   clear_last_error();
 
+#if defined(__linux__) && defined(SOCK_NONBLOCK) && defined(SOCK_CLOEXEC)
+  // One system call sets both flags on the new descriptor.
+  int accept_flags = 0;
+  if (flags & accept_non_blocking)
+    accept_flags |= SOCK_NONBLOCK;
+  if (flags & accept_close_on_exec)
+    accept_flags |= SOCK_CLOEXEC;
+  socket_type new_s = error_wrapper(call_accept4(
+        &msghdr::msg_namelen, s, addr, addrlen, accept_flags), ec);
+  if (new_s == invalid_socket)
+    return new_s;
+#else // defined(__linux__) && defined(SOCK_NONBLOCK) && defined(SOCK_CLOEXEC)
   socket_type new_s = error_wrapper(call_accept(
         &msghdr::msg_namelen, s, addr, addrlen), ec);
   if (new_s == invalid_socket)
     return new_s;
 
+  if (flags & accept_non_blocking)
+  {
+    clear_last_error();
+    ioctl_arg_type arg = 1;
+# if defined(_WIN32) || defined(__CYGWIN__)
+    int result = error_wrapper(::ioctlsocket(new_s, FIONBIO, &arg), ec);
+# else // defined(_WIN32) || defined(__CYGWIN__)
+    int result = error_wrapper(::ioctl(new_s, FIONBIO, &arg), ec);
+# endif // defined(_WIN32) || defined(__CYGWIN__)
+    if (result < 0)
+    {
+      state_type state = 0;
+      std::error_code ignored_ec;
+      close(new_s, state, true, ignored_ec);
+      return invalid_socket;
+    }
+  }
+
+# if !defined(_WIN32) && !defined(__CYGWIN__) && defined(FD_CLOEXEC)
+  if (flags & accept_close_on_exec)
+  {
+    clear_last_error();
+    if (error_wrapper(::fcntl(new_s, F_SETFD, FD_CLOEXEC), ec) < 0)
+    {
+      state_type state = 0;
+      std::error_code ignored_ec;
+      close(new_s, state, true, ignored_ec);
+      return invalid_socket;
+    }
+  }
+# endif // !defined(_WIN32) && !defined(__CYGWIN__) && defined(FD_CLOEXEC)
+#endif // defined(__linux__) && defined(SOCK_NONBLOCK) && defined(SOCK_CLOEXEC)
+
 #if defined(__MACH__) && defined(__APPLE__) || defined(__FreeBSD__)
   int optval = 1;
   int result = error_wrapper(::setsockopt(new_s,
@@ -408,7 +472,7 @@ int connect(socket_type s, const socket_addr_type* addr,
     ec = std::error_code();
 #if defined(__linux__)
   else if (ec == std::errc::resource_unavailable_try_again)
-    ec = std::error::no_buffer_space;
+    ec = std::make_error_code(std::errc::no_buffer_space);
 #endif // defined(__linux__)
   return result;
 }
@@ -440,6 +504,54 @@ void sync_connect(socket_type s, const socket_addr_type* addr,
   ec = std::error_code(connect_error, std::generic_category());
 }
 
+signed_size_type sync_connect_and_send(socket_type s,
+    const buf* bufs, size_t count, const socket_addr_type* addr,
+    std::size_t addrlen, std::error_code& ec)
+{
+#if defined(MSG_FASTOPEN)
+  // Connect and send in one call. If the kernel has a Fast Open cookie for
+  // the peer, the data rides on the SYN; otherwise it asks for a cookie and
+  // the data follows the handshake.
+  signed_size_type result = socket_ops::sendto(s, bufs, count,
+      MSG_FASTOPEN, addr, addrlen, ec);
+  if (result >= 0)
+    return result;
+
+  if (ec == std::errc::operation_in_progress)
+  {
+    // A non-blocking socket without a cookie: the handshake has started but
+    // nothing was sent. Wait for it as sync_connect does.
+    if (socket_ops::poll_connect(s, -1, ec) < 0)
+      return socket_error_retval;
+    int connect_error = 0;
+    size_t connect_error_len = sizeof(connect_error);
+    if (socket_ops::getsockopt(s, 0, SOL_SOCKET, SO_ERROR,
+          &connect_error, &connect_error_len, ec) == socket_error_retval)
+      return socket_error_retval;
+    if (connect_error)
+    {
+      ec = std::error_code(connect_error, std::generic_category());
+      return socket_error_retval;
+    }
+  }
+  else if (ec == std::errc::operation_not_supported)
+  {
+    // Fast Open is turned off for clients (net.ipv4.tcp_fastopen).
+    sync_connect(s, addr, addrlen, ec);
+    if (ec)
+      return socket_error_retval;
+  }
+  else
+    return socket_error_retval;
+#else // defined(MSG_FASTOPEN)
+  sync_connect(s, addr, addrlen, ec);
+  if (ec)
+    return socket_error_retval;
+#endif // defined(MSG_FASTOPEN)
+
+  return socket_ops::send(s, bufs, count, 0, ec);
+}
+
 bool non_blocking_connect(socket_type s, std::error_code& ec)
 {
   // Check if the connect operation has finished. This is required since we may
@@ -564,6 +676,26 @@ size_t available(socket_type s, std::error_code& ec)
   return ec ? static_cast<size_t>(0) : static_cast<size_t>(value);
 }
 
+size_t send_queue_size(socket_type s, std::error_code& ec)
+{
+  if (s == invalid_socket)
+  {
+    ec = std::make_error_code(std::errc::bad_file_descriptor);
+    return 0;
+  }
+
+#if defined(SIOCOUTQ)
+  int value = 0;
+  int result = error_wrapper(::ioctl(s, SIOCOUTQ, &value), ec);
+  if (result == 0)
+    ec = std::error_code();
+  return ec || value < 0 ? static_cast<size_t>(0) : static_cast<size_t>(value);
+#else // defined(SIOCOUTQ)
+  ec = std::make_error_code(std::errc::operation_not_supported);
+  return 0;
+#endif // defined(SIOCOUTQ)
+}
+
 int listen(socket_type s, int backlog, std::error_code& ec)
 {
   if (s == invalid_socket)
@@ -1979,60 +2111,58 @@ NETWORK_API struct hostent* gethostbyname(const char* name, std::error_code& ec)
     return result;
 }
 
-NETWORK_API bool resolve(const char* hostname, struct sockaddr_in6 *out, std::error_code& ec)
+std::size_t resolve(const char* hostname, int af,
+    sockaddr_storage_type* out, std::size_t out_count, std::error_code& ec)
 {
-    clear_last_error();
-    struct hostent *phent = nullptr;
-#if defined(__linux__)
-    struct hostent hent;
-    memset(&hent, 0, sizeof(hent));
-    int32_t herrno = 0;
-    char buffer[64 * 1024] = { 0 };
-    int32_t ret = ::gethostbyname_r(hostname.data(), &hent, buffer, sizeof buffer, &phent, &herrno);
-    if (ret == 0 && phent != nullptr)
-    {
-        assert(phent->h_addrtype == AF_INET6);
-        out->sin6_addr = *reinterpret_cast<struct in6_addr*>(phent->h_addr);
-        return true;
-    }
-    else
+  addrinfo_type hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = af;
+  // One entry per address, rather than one per address and protocol.
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo_type* address_info = 0;
+  if (socket_ops::getaddrinfo(hostname, 0, hints, &address_info, ec))
+    return 0;
+
+  // Keep counting past out_count, so the caller can tell a short buffer
+  // from a missing host.
+  std::size_t count = 0;
+  for (addrinfo_type* ai = address_info; ai; ai = ai->ai_next)
+  {
+    if (ai->ai_family != NET_OS_DEF(AF_INET) && ai->ai_family != NET_OS_DEF(AF_INET6))
+      continue;
+    if (ai->ai_addrlen > sizeof(sockaddr_storage_type))
+      continue;
+    if (count < out_count)
     {
-        return false;
+      memset(&out[count], 0, sizeof(sockaddr_storage_type));
+      memcpy(&out[count], ai->ai_addr, ai->ai_addrlen);
     }
-#else
-    phent = error_wrapper(::gethostbyname(hostname), ec);
-    assert(phent->h_addrtype == AF_INET6);
-    out->sin6_addr = *reinterpret_cast<struct in6_addr*>(phent->h_addr);
-    return true;
-#endif
+    ++count;
+  }
+  socket_ops::freeaddrinfo(address_info);
+
+  if (count == 0)
+    ec = std::error_code(NET_NETDB_ERROR(HOST_NOT_FOUND), std::system_category());
+  return count;
 }
 
-NETWORK_API bool resolve(const char* hostname, struct sockaddr_in *out, std::error_code& ec)
+bool resolve(const char* hostname, struct sockaddr_in6 *out, std::error_code& ec)
 {
-    clear_last_error();
-    struct hostent *phent = nullptr;
-#if defined(__linux__)
-    struct hostent hent;
-    memset(&hent, 0, sizeof(hent));
-    int32_t herrno = 0;
-    char buffer[64 * 1024] = { 0 };
-    int32_t ret = ::gethostbyname_r(hostname.data(), &hent, buffer, sizeof buffer, &phent, &herrno);
-    if (ret == 0 && phent != nullptr)
-    {
-        assert(phent->h_addrtype == AF_INET);
-        out->sin_addr = *reinterpret_cast<struct in_addr*>(phent->h_addr);
-        return true;
-    }
-    else
-    {
-        return false;
-    }
-#else
-    phent = error_wrapper(::gethostbyname(hostname), ec);
-    assert(phent->h_addrtype == AF_INET);
-    out->sin_addr = *reinterpret_cast<struct in_addr*>(phent->h_addr);
-    return true;
-#endif
+  sockaddr_storage_type storage;
+  if (resolve(hostname, NET_OS_DEF(AF_INET6), &storage, 1, ec) == 0)
+    return false;
+  out->sin6_addr = reinterpret_cast<sockaddr_in6_type*>(&storage)->sin6_addr;
+  return true;
+}
+
+bool resolve(const char* hostname, struct sockaddr_in *out, std::error_code& ec)
+{
+  sockaddr_storage_type storage;
+  if (resolve(hostname, NET_OS_DEF(AF_INET), &storage, 1, ec) == 0)
+    return false;
+  out->sin_addr = reinterpret_cast<sockaddr_in4_type*>(&storage)->sin_addr;
+  return true;
 }
 
 inline std::error_code translate_addrinfo_error(int error)
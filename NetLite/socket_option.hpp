@@ -8,7 +8,10 @@
 
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
+#include <string>
 #include "NetLite/net_error_code.hpp"
 #include "NetLite/socket_types.hpp"
 #include "NetLite/ip/address.hpp"
@@ -407,7 +410,7 @@ public:
             if (s != sizeof(ipv6_value_))
             {
                 std::length_error ex("multicast_enable_loopback socket option resize");
-                throw_exception(ex);
+                throw ex;
             }
             ipv4_value_ = ipv6_value_ ? 1 : 0;
         }
@@ -416,7 +419,7 @@ public:
             if (s != sizeof(ipv4_value_))
             {
                 std::length_error ex("multicast_enable_loopback socket option resize");
-                throw_exception(ex);
+                throw ex;
             }
             ipv6_value_ = ipv4_value_ ? 1 : 0;
         }
@@ -503,7 +506,7 @@ public:
         if (s != sizeof(value_))
         {
             std::length_error ex("unicast hops socket option resize");
-            throw_exception(ex);
+            throw ex;
         }
 #if defined(__hpux)
         if (value_ < 0)
@@ -540,7 +543,7 @@ public:
         if (v < 0 || v > 255)
         {
             std::out_of_range ex("multicast hops value out of range");
-            throw_exception(ex);
+            throw ex;
         }
         ipv4_value_ = (ipv4_value_type)v;
         ipv6_value_ = v;
@@ -552,7 +555,7 @@ public:
         if (v < 0 || v > 255)
         {
             std::out_of_range ex("multicast hops value out of range");
-            throw_exception(ex);
+            throw ex;
         }
         ipv4_value_ = (ipv4_value_type)v;
         ipv6_value_ = v;
@@ -619,7 +622,7 @@ public:
             if (s != sizeof(ipv6_value_))
             {
                 std::length_error ex("multicast hops socket option resize");
-                throw_exception(ex);
+                throw ex;
             }
             if (ipv6_value_ < 0)
                 ipv4_value_ = 0;
@@ -633,7 +636,7 @@ public:
             if (s != sizeof(ipv4_value_))
             {
                 std::length_error ex("multicast hops socket option resize");
-                throw_exception(ex);
+                throw ex;
             }
             ipv6_value_ = ipv4_value_;
         }
@@ -825,6 +828,366 @@ private:
     unsigned int ipv6_value_;
 };
 
+// Helper template for implementing options whose value is a short string,
+// such as a name.
+template <int Level, int Name>
+class string
+{
+public:
+    // Default constructor.
+    string()
+        : size_(0)
+    {
+        std::memset(value_, 0, sizeof(value_));
+    }
+
+    // Construct with a specific option value.
+    explicit string(const std::string& v)
+    {
+        assign(v);
+    }
+
+    // Set the value of the option.
+    string& operator=(const std::string& v)
+    {
+        assign(v);
+        return *this;
+    }
+
+    // Get the current value of the option.
+    std::string value() const
+    {
+        std::size_t length = 0;
+        while (length < size_ && value_[length] != 0)
+            ++length;
+        return std::string(value_, length);
+    }
+
+    // Get the level of the socket option.
+    template <typename Protocol>
+    int level(const Protocol&) const
+    {
+        return Level;
+    }
+
+    // Get the name of the socket option.
+    template <typename Protocol>
+    int name(const Protocol&) const
+    {
+        return Name;
+    }
+
+    // Get the address of the string data.
+    template <typename Protocol>
+    char* data(const Protocol&)
+    {
+        return value_;
+    }
+
+    // Get the address of the string data.
+    template <typename Protocol>
+    const char* data(const Protocol&) const
+    {
+        return value_;
+    }
+
+    // Get the size of the buffer to get the option into. get_option() uses
+    // this overload, so the whole buffer is offered whatever an earlier set
+    // or get left in size_.
+    template <typename Protocol>
+    std::size_t size(const Protocol&)
+    {
+        return sizeof(value_);
+    }
+
+    // Get the size of the string data to set: only the characters.
+    template <typename Protocol>
+    std::size_t size(const Protocol&) const
+    {
+        return size_;
+    }
+
+    // Set the size of the string data.
+    template <typename Protocol>
+    void resize(const Protocol&, std::size_t s)
+    {
+        if (s > sizeof(value_))
+        {
+            std::length_error ex("string socket option resize");
+            throw ex;
+        }
+        size_ = s;
+    }
+
+private:
+    void assign(const std::string& v)
+    {
+        if (v.size() >= sizeof(value_))
+        {
+            std::length_error ex("string socket option value too long");
+            throw ex;
+        }
+        std::memset(value_, 0, sizeof(value_));
+        std::memcpy(value_, v.data(), v.size());
+        size_ = v.size();
+    }
+
+    char value_[32];
+    std::size_t size_;
+};
+
+#if defined(NETWORK_HAS_TCP_INFO)
+
+// The layout of the Linux struct tcp_info, which the kernel only ever
+// extends at the end. glibc's copy stops at tcpi_total_retrans, so the
+// fields after it are declared here.
+struct tcp_info_data
+{
+    uint8_t state;
+    uint8_t ca_state;
+    uint8_t retransmits;
+    uint8_t probes;
+    uint8_t backoff;
+    uint8_t options;
+    uint8_t wscale;
+    uint8_t flags;
+
+    uint32_t rto;
+    uint32_t ato;
+    uint32_t snd_mss;
+    uint32_t rcv_mss;
+
+    uint32_t unacked;
+    uint32_t sacked;
+    uint32_t lost;
+    uint32_t retrans;
+    uint32_t fackets;
+
+    uint32_t last_data_sent;
+    uint32_t last_ack_sent;
+    uint32_t last_data_recv;
+    uint32_t last_ack_recv;
+
+    uint32_t pmtu;
+    uint32_t rcv_ssthresh;
+    uint32_t rtt;
+    uint32_t rttvar;
+    uint32_t snd_ssthresh;
+    uint32_t snd_cwnd;
+    uint32_t advmss;
+    uint32_t reordering;
+
+    uint32_t rcv_rtt;
+    uint32_t rcv_space;
+
+    uint32_t total_retrans;
+
+    uint64_t pacing_rate;
+    uint64_t max_pacing_rate;
+    uint64_t bytes_acked;
+    uint64_t bytes_received;
+    uint32_t segs_out;
+    uint32_t segs_in;
+
+    uint32_t notsent_bytes;
+    uint32_t min_rtt;
+    uint32_t data_segs_in;
+    uint32_t data_segs_out;
+
+    uint64_t delivery_rate;
+
+    uint64_t busy_time;
+    uint64_t rwnd_limited;
+    uint64_t sndbuf_limited;
+
+    uint32_t delivered;
+    uint32_t delivered_ce;
+
+    uint64_t bytes_sent;
+    uint64_t bytes_retrans;
+    uint32_t dsack_dups;
+    uint32_t reord_seen;
+
+    uint32_t rcv_ooopack;
+
+    uint32_t snd_wnd;
+};
+
+// Helper template for implementing the TCP_INFO option. It can only be
+// read. Fields the running kernel does not report are zero.
+template <int Level, int Name>
+class tcp_info
+{
+public:
+    // Default constructor.
+    tcp_info()
+        : size_(0)
+    {
+        std::memset(&value_, 0, sizeof(value_));
+    }
+
+    // Get the raw kernel data.
+    const tcp_info_data& data() const
+    {
+        return value_;
+    }
+
+    // Get the number of bytes the kernel filled in.
+    std::size_t filled() const
+    {
+        return size_;
+    }
+
+    // Get the state of the connection, one of the TCP_ESTABLISHED family.
+    int state() const
+    {
+        return value_.state;
+    }
+
+    // Get the smoothed round trip time, in microseconds.
+    uint32_t rtt() const
+    {
+        return value_.rtt;
+    }
+
+    // Get the round trip time variance, in microseconds.
+    uint32_t rtt_variance() const
+    {
+        return value_.rttvar;
+    }
+
+    // Get the lowest round trip time seen, in microseconds.
+    uint32_t min_rtt() const
+    {
+        return value_.min_rtt;
+    }
+
+    // Get the congestion window, in segments.
+    uint32_t congestion_window() const
+    {
+        return value_.snd_cwnd;
+    }
+
+    // Get the sender's maximum segment size, in bytes.
+    uint32_t mss() const
+    {
+        return value_.snd_mss;
+    }
+
+    // Get the number of segments retransmitted over the connection's life.
+    uint32_t retransmits() const
+    {
+        return value_.total_retrans;
+    }
+
+    // Get the current pacing rate, in bytes per second.
+    uint64_t pacing_rate() const
+    {
+        return value_.pacing_rate;
+    }
+
+    // Get the most recent delivery rate estimate, in bytes per second.
+    uint64_t delivery_rate() const
+    {
+        return value_.delivery_rate;
+    }
+
+    // Determine whether the delivery rate was measured while the application,
+    // not the network, was the bottleneck.
+    bool delivery_rate_app_limited() const
+    {
+        return (value_.flags & 1) != 0;
+    }
+
+    // Get the number of segments sent but not yet acknowledged.
+    uint32_t unacked() const
+    {
+        return value_.unacked;
+    }
+
+    // Estimate the number of bytes sent but not yet acknowledged, as the
+    // unacknowledged segments times the MSS; it overstates when the last
+    // segment is short. TCP_INFO has no exact count: bytes_acked includes
+    // the SYN on the connecting side only. tcp_info_sampler reads the exact
+    // value from the send queue.
+    uint64_t unacked_bytes() const
+    {
+        return static_cast<uint64_t>(value_.unacked) * value_.snd_mss;
+    }
+
+    // Get the number of bytes written by the application but not yet sent.
+    uint32_t notsent_bytes() const
+    {
+        return value_.notsent_bytes;
+    }
+
+    // Get the time spent sending, in microseconds.
+    uint64_t busy_time() const
+    {
+        return value_.busy_time;
+    }
+
+    // Get the part of the busy time spent limited by the peer's receive
+    // window, in microseconds.
+    uint64_t rwnd_limited() const
+    {
+        return value_.rwnd_limited;
+    }
+
+    // Get the part of the busy time spent limited by the send buffer, in
+    // microseconds.
+    uint64_t sndbuf_limited() const
+    {
+        return value_.sndbuf_limited;
+    }
+
+    // Get the level of the socket option.
+    template <typename Protocol>
+    int level(const Protocol&) const
+    {
+        return Level;
+    }
+
+    // Get the name of the socket option.
+    template <typename Protocol>
+    int name(const Protocol&) const
+    {
+        return Name;
+    }
+
+    // Get the address of the option data.
+    template <typename Protocol>
+    tcp_info_data* data(const Protocol&)
+    {
+        return &value_;
+    }
+
+    // Get the size of the option data.
+    template <typename Protocol>
+    std::size_t size(const Protocol&) const
+    {
+        return sizeof(value_);
+    }
+
+    // Set the size of the option data. An older kernel returns less.
+    template <typename Protocol>
+    void resize(const Protocol&, std::size_t s)
+    {
+        if (s > sizeof(value_))
+        {
+            std::length_error ex("tcp_info socket option resize");
+            throw ex;
+        }
+        size_ = s;
+    }
+
+private:
+    tcp_info_data value_;
+    std::size_t size_;
+};
+
+#endif // defined(NETWORK_HAS_TCP_INFO)
+
 } // namespace socket_option
 } // namespace NetLite
 
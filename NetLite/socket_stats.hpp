@@ -0,0 +1,249 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_SOCKET_STATS_HPP
+#define NETLITE_SOCKET_STATS_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+#include "NetLite/config.hpp"
+
+namespace NetLite{
+
+/**
+ * I/O counters of one socket.
+ *
+ * A basic_socket keeps these only when NETWORK_ENABLE_SOCKET_STATS is
+ * defined; copies of a socket share them. Every counter is a relaxed atomic,
+ * and a cache line of padding keeps the send and receive sides apart, so a
+ * thread that sends and one that receives on the same socket do not contend.
+ * load() reads each counter once; counters updated while it runs may or
+ * may not be included.
+ *
+ * A send or receive counts as one system call. The time spent waiting is
+ * the time basic_socket::wait() and has_state() spend in poll_read() and
+ * poll_write().
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Safe.
+ */
+class socket_stats
+{
+public:
+    /// A copy of the counters at one point in time.
+    struct snapshot
+    {
+        /// Bytes transferred by successful sends.
+        uint64_t bytes_sent;
+
+        /// Send calls that transferred data.
+        uint64_t send_ops;
+
+        /// Sends that transferred less than was asked for.
+        uint64_t short_writes;
+
+        /// Sends that failed because the socket would block.
+        uint64_t send_would_block;
+
+        /// System calls made to send, connect or wait until writable.
+        uint64_t send_syscalls;
+
+        /// Waits until writable, and the nanoseconds spent in them.
+        uint64_t poll_writes;
+        uint64_t poll_write_ns;
+
+        /// Bytes transferred by successful receives.
+        uint64_t bytes_received;
+
+        /// Receive calls that transferred data or reported end of stream.
+        uint64_t receive_ops;
+
+        /// Receives that filled less than the buffers given.
+        uint64_t short_reads;
+
+        /// Receives that failed because the socket would block.
+        uint64_t receive_would_block;
+
+        /// System calls made to receive, accept or wait until readable.
+        uint64_t receive_syscalls;
+
+        /// Waits until readable, and the nanoseconds spent in them.
+        uint64_t poll_reads;
+        uint64_t poll_read_ns;
+
+        /// Sends and receives that failed because the socket would block.
+        uint64_t would_block() const
+        {
+            return send_would_block + receive_would_block;
+        }
+
+        /// All system calls counted.
+        uint64_t syscalls() const
+        {
+            return send_syscalls + receive_syscalls;
+        }
+
+        /// Mean bytes per send; a small value on a busy socket points at
+        /// writes that should have been batched.
+        double mean_send_size() const
+        {
+            return send_ops ? static_cast<double>(bytes_sent) / static_cast<double>(send_ops) : 0.0;
+        }
+
+        /// Mean bytes per receive.
+        double mean_receive_size() const
+        {
+            return receive_ops ? static_cast<double>(bytes_received) / static_cast<double>(receive_ops) : 0.0;
+        }
+    };
+
+    socket_stats() noexcept
+    {
+        reset();
+    }
+
+    socket_stats(const socket_stats&) = delete;
+    socket_stats& operator=(const socket_stats&) = delete;
+
+    /// Count a send that asked for requested bytes.
+    void record_send(std::size_t requested, std::size_t transferred, const std::error_code& ec) noexcept
+    {
+        record(send_, requested, transferred, ec);
+    }
+
+    /// Count a receive into buffers of requested bytes.
+    void record_receive(std::size_t requested, std::size_t transferred, const std::error_code& ec) noexcept
+    {
+        record(receive_, requested, transferred, ec);
+    }
+
+    /// Count a system call that is neither a send nor a receive, made on the
+    /// sending side (connect) or the receiving side (accept).
+    void record_send_syscall() noexcept
+    {
+        add(send_.syscalls, 1);
+    }
+
+    void record_receive_syscall() noexcept
+    {
+        add(receive_.syscalls, 1);
+    }
+
+    /// Count a wait until writable that took the given time.
+    void record_poll_write(uint64_t ns) noexcept
+    {
+        add(send_.syscalls, 1);
+        add(send_.polls, 1);
+        add(send_.poll_ns, ns);
+    }
+
+    /// Count a wait until readable that took the given time.
+    void record_poll_read(uint64_t ns) noexcept
+    {
+        add(receive_.syscalls, 1);
+        add(receive_.polls, 1);
+        add(receive_.poll_ns, ns);
+    }
+
+    /// Read all counters.
+    snapshot load() const noexcept
+    {
+        snapshot s;
+        s.bytes_sent = send_.bytes.load(std::memory_order_relaxed);
+        s.send_ops = send_.ops.load(std::memory_order_relaxed);
+        s.short_writes = send_.short_ops.load(std::memory_order_relaxed);
+        s.send_would_block = send_.would_block.load(std::memory_order_relaxed);
+        s.send_syscalls = send_.syscalls.load(std::memory_order_relaxed);
+        s.poll_writes = send_.polls.load(std::memory_order_relaxed);
+        s.poll_write_ns = send_.poll_ns.load(std::memory_order_relaxed);
+        s.bytes_received = receive_.bytes.load(std::memory_order_relaxed);
+        s.receive_ops = receive_.ops.load(std::memory_order_relaxed);
+        s.short_reads = receive_.short_ops.load(std::memory_order_relaxed);
+        s.receive_would_block = receive_.would_block.load(std::memory_order_relaxed);
+        s.receive_syscalls = receive_.syscalls.load(std::memory_order_relaxed);
+        s.poll_reads = receive_.polls.load(std::memory_order_relaxed);
+        s.poll_read_ns = receive_.poll_ns.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    /// Set all counters to zero.
+    void reset() noexcept
+    {
+        clear(send_);
+        clear(receive_);
+    }
+
+    /// The clock used to time waits, in nanoseconds.
+    static uint64_t now_ns() noexcept
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+private:
+    struct direction
+    {
+        std::atomic<uint64_t> bytes;
+        std::atomic<uint64_t> ops;
+        std::atomic<uint64_t> short_ops;
+        std::atomic<uint64_t> would_block;
+        std::atomic<uint64_t> syscalls;
+        std::atomic<uint64_t> polls;
+        std::atomic<uint64_t> poll_ns;
+    };
+
+    static void add(std::atomic<uint64_t>& counter, uint64_t n) noexcept
+    {
+        counter.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    static void record(direction& d, std::size_t requested, std::size_t transferred,
+        const std::error_code& ec) noexcept
+    {
+        add(d.syscalls, 1);
+        if (ec)
+        {
+            if (ec == std::errc::operation_would_block || ec == std::errc::resource_unavailable_try_again)
+                add(d.would_block, 1);
+            return;
+        }
+        add(d.ops, 1);
+        add(d.bytes, transferred);
+        if (transferred != 0 && transferred < requested)
+            add(d.short_ops, 1);
+    }
+
+    static void clear(direction& d) noexcept
+    {
+        d.bytes.store(0, std::memory_order_relaxed);
+        d.ops.store(0, std::memory_order_relaxed);
+        d.short_ops.store(0, std::memory_order_relaxed);
+        d.would_block.store(0, std::memory_order_relaxed);
+        d.syscalls.store(0, std::memory_order_relaxed);
+        d.polls.store(0, std::memory_order_relaxed);
+        d.poll_ns.store(0, std::memory_order_relaxed);
+    }
+
+    // Padding rather than alignas: before C++17 make_shared and new ignore
+    // over-alignment, so the object may start anywhere in a cache line.
+    // A full line between the two sides keeps them apart wherever it does.
+    enum { cache_line_size = 64 };
+    direction send_;
+    char padding_[cache_line_size];
+    direction receive_;
+};
+
+} // namespace NetLite
+
+#endif // END OF NETLITE_SOCKET_STATS_HPP
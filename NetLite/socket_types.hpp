@@ -60,6 +60,9 @@
 #  include <sys/filio.h>
 #  include <sys/sockio.h>
 # endif
+# if defined(__linux__)
+#  include <linux/sockios.h>
+# endif
 # include <unistd.h>
 #endif
 
@@ -244,6 +247,9 @@ namespace NetLite{
 # define NET_OS_DEF_SO_RCVLOWAT SO_RCVLOWAT
 # define NET_OS_DEF_SO_REUSEADDR SO_REUSEADDR
 # define NET_OS_DEF_TCP_NODELAY TCP_NODELAY
+# if defined(TCP_INFO)
+#  define NET_OS_DEF_TCP_INFO TCP_INFO
+# endif // defined(TCP_INFO)
 # define NET_OS_DEF_IP_MULTICAST_IF IP_MULTICAST_IF
 # define NET_OS_DEF_IP_MULTICAST_TTL IP_MULTICAST_TTL
 # define NET_OS_DEF_IP_MULTICAST_LOOP IP_MULTICAST_LOOP
@@ -6,6 +6,8 @@
 # pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
+#include <string>
+#include <system_error>
 #include "NetLite/basic_socket.hpp"
 #include "NetLite/basic_endpoint.hpp"
 #include "NetLite/socket_option.hpp"
@@ -30,6 +32,8 @@ public:
     typedef basic_endpoint<tcp> endpoint;
     /// The TCP socket type.
     typedef basic_socket<tcp> socket;
+    /// The move-only TCP socket type, which stores its descriptor inline.
+    typedef basic_socket<tcp, unique_socket_holder> unique_socket;
 
     tcp()
         : family_(NET_OS_DEF(AF_INET))
@@ -95,6 +99,287 @@ public:
     */
     typedef NetLite::socket_option::boolean<NET_OS_DEF(IPPROTO_TCP), NET_OS_DEF(TCP_NODELAY) > no_delay;
 
+#if defined(TCP_QUICKACK)
+    /**
+    * Socket option for sending ACKs immediately instead of delaying them.
+    * Implements the IPPROTO_TCP/TCP_QUICKACK socket option. The kernel may
+    * fall back to delayed ACKs at any time, so set it again after each
+    * receive where it matters.
+    *
+    * @par Concepts:
+    * Socket_Option, Boolean_Socket_Option.
+    */
+    typedef NetLite::socket_option::boolean<NET_OS_DEF(IPPROTO_TCP), TCP_QUICKACK> quick_ack;
+#endif // defined(TCP_QUICKACK)
+
+#if defined(TCP_CORK)
+    /**
+    * Socket option for holding back partial segments.
+    * Implements the IPPROTO_TCP/TCP_CORK socket option. While set, only full
+    * segments are sent; clearing it sends whatever is queued. Queued data is
+    * also sent after 200 ms.
+    *
+    * @par Examples
+    * Sending a header and a body as few segments as possible:
+    * @code
+    * socket.set_option(NetLite::tcp::cork(true));
+    * socket.send(header);
+    * socket.send(body);
+    * socket.set_option(NetLite::tcp::cork(false));
+    * @endcode
+    *
+    * @par Concepts:
+    * Socket_Option, Boolean_Socket_Option.
+    */
+    typedef NetLite::socket_option::boolean<NET_OS_DEF(IPPROTO_TCP), TCP_CORK> cork;
+#endif // defined(TCP_CORK)
+
+#if defined(TCP_NOTSENT_LOWAT)
+    /**
+    * Socket option for the amount of unsent data the kernel accepts.
+    * Implements the IPPROTO_TCP/TCP_NOTSENT_LOWAT socket option, in bytes.
+    * The socket only reports writable while less than this much written
+    * data is still unsent, which keeps data in the application, where it
+    * can still be replaced or reprioritised, instead of in the send buffer.
+    *
+    * @par Concepts:
+    * Socket_Option, Integer_Socket_Option.
+    */
+    typedef NetLite::socket_option::integer<NET_OS_DEF(IPPROTO_TCP), TCP_NOTSENT_LOWAT> notsent_low_watermark;
+#endif // defined(TCP_NOTSENT_LOWAT)
+
+#if defined(TCP_USER_TIMEOUT)
+    /**
+    * Socket option for how long sent data may stay unacknowledged.
+    * Implements the IPPROTO_TCP/TCP_USER_TIMEOUT socket option, in
+    * milliseconds. When it expires the connection is closed with
+    * std::errc::timed_out. Zero uses the system default.
+    *
+    * @par Concepts:
+    * Socket_Option, Integer_Socket_Option.
+    */
+    typedef NetLite::socket_option::integer<NET_OS_DEF(IPPROTO_TCP), TCP_USER_TIMEOUT> user_timeout;
+#endif // defined(TCP_USER_TIMEOUT)
+
+#if defined(TCP_KEEPIDLE)
+    /**
+    * Socket option for the idle time before the first keepalive probe.
+    * Implements the IPPROTO_TCP/TCP_KEEPIDLE socket option, in seconds. It
+    * only has an effect once socket_base::keep_alive is set.
+    *
+    * @par Concepts:
+    * Socket_Option, Integer_Socket_Option.
+    */
+    typedef NetLite::socket_option::integer<NET_OS_DEF(IPPROTO_TCP), TCP_KEEPIDLE> keep_alive_idle;
+#endif // defined(TCP_KEEPIDLE)
+
+#if defined(TCP_KEEPINTVL)
+    /**
+    * Socket option for the time between keepalive probes.
+    * Implements the IPPROTO_TCP/TCP_KEEPINTVL socket option, in seconds.
+    *
+    * @par Concepts:
+    * Socket_Option, Integer_Socket_Option.
+    */
+    typedef NetLite::socket_option::integer<NET_OS_DEF(IPPROTO_TCP), TCP_KEEPINTVL> keep_alive_interval;
+#endif // defined(TCP_KEEPINTVL)
+
+#if defined(TCP_KEEPCNT)
+    /**
+    * Socket option for the number of unanswered keepalive probes before the
+    * connection is dropped.
+    * Implements the IPPROTO_TCP/TCP_KEEPCNT socket option.
+    *
+    * @par Concepts:
+    * Socket_Option, Integer_Socket_Option.
+    */
+    typedef NetLite::socket_option::integer<NET_OS_DEF(IPPROTO_TCP), TCP_KEEPCNT> keep_alive_count;
+#endif // defined(TCP_KEEPCNT)
+
+#if defined(TCP_DEFER_ACCEPT)
+    /**
+    * Socket option for accepting connections only once data has arrived.
+    * Implements the IPPROTO_TCP/TCP_DEFER_ACCEPT socket option on a
+    * listening socket. The value is how many seconds to wait for the first
+    * data before accepting the connection anyway.
+    *
+    * @par Concepts:
+    * Socket_Option, Integer_Socket_Option.
+    */
+    typedef NetLite::socket_option::integer<NET_OS_DEF(IPPROTO_TCP), TCP_DEFER_ACCEPT> defer_accept;
+#endif // defined(TCP_DEFER_ACCEPT)
+
+#if defined(TCP_FASTOPEN)
+    /**
+    * Socket option for accepting TCP Fast Open connections.
+    * Implements the IPPROTO_TCP/TCP_FASTOPEN socket option on a listening
+    * socket. The value is the most connections that may wait in the queue
+    * with data received before the handshake completed. Set it before
+    * listen().
+    *
+    * @par Concepts:
+    * Socket_Option, Integer_Socket_Option.
+    */
+    typedef NetLite::socket_option::integer<NET_OS_DEF(IPPROTO_TCP), TCP_FASTOPEN> fast_open;
+#endif // defined(TCP_FASTOPEN)
+
+#if defined(TCP_CONGESTION)
+    /**
+    * Socket option for the congestion control algorithm.
+    * Implements the IPPROTO_TCP/TCP_CONGESTION socket option. The value is
+    * an algorithm name such as "cubic" or "bbr"; setting one that is not
+    * loaded fails with std::errc::no_such_file_or_directory.
+    *
+    * @par Examples
+    * @code
+    * socket.set_option(NetLite::tcp::congestion_control("bbr"));
+    * @endcode
+    *
+    * @par Concepts:
+    * Socket_Option.
+    */
+    typedef NetLite::socket_option::string<NET_OS_DEF(IPPROTO_TCP), TCP_CONGESTION> congestion_control;
+#endif // defined(TCP_CONGESTION)
+
+    /**
+    * A set of latency-oriented options applied to a socket in one call.
+    * The default values disable Nagle's algorithm and delayed ACKs and keep
+    * at most 16 KB of written data unsent in the kernel. Every other setting
+    * is left alone unless given a value; options the platform does not
+    * provide are skipped.
+    *
+    * @par Examples
+    * @code
+    * NetLite::tcp::low_latency_profile profile;
+    * profile.user_timeout = 5000;
+    * profile.keep_alive_idle = 10;
+    * profile.apply(socket);
+    * @endcode
+    */
+    class low_latency_profile
+    {
+    public:
+        low_latency_profile()
+            : no_delay(true)
+            , quick_ack(true)
+            , notsent_low_watermark(16384)
+            , user_timeout(0)
+            , keep_alive_idle(0)
+            , keep_alive_interval(0)
+            , keep_alive_count(0)
+        {
+        }
+
+        /// Set tcp::no_delay.
+        bool no_delay;
+
+        /// Set tcp::quick_ack.
+        bool quick_ack;
+
+        /// The tcp::notsent_low_watermark in bytes, or 0 to leave it alone.
+        int notsent_low_watermark;
+
+        /// The tcp::user_timeout in milliseconds, or 0 to leave it alone.
+        int user_timeout;
+
+        /// The keepalive settings, each 0 to leave it alone. Setting any of
+        /// them also turns on socket_base::keep_alive.
+        int keep_alive_idle;
+        int keep_alive_interval;
+        int keep_alive_count;
+
+        /// The congestion control algorithm, or empty to leave it alone.
+        std::string congestion_control;
+
+        /**
+         * Apply the profile to a socket.
+         * @throws std::system_error Thrown on failure.
+         */
+        template <typename Holder>
+        void apply(basic_socket<tcp, Holder>& socket) const
+        {
+            std::error_code ec;
+            apply(socket, ec);
+            throw_if(ec, "low_latency_profile");
+        }
+
+        /**
+         * Apply the profile to a socket. Stops at the first option that
+         * fails.
+         * @param ec Set to indicate what error occurred, if any.
+         */
+        template <typename Holder>
+        std::error_code apply(basic_socket<tcp, Holder>& socket, std::error_code& ec) const
+        {
+            ec = std::error_code();
+            if (no_delay && socket.set_option(tcp::no_delay(true), ec))
+                return ec;
+#if defined(TCP_QUICKACK)
+            if (quick_ack && socket.set_option(tcp::quick_ack(true), ec))
+                return ec;
+#endif // defined(TCP_QUICKACK)
+#if defined(TCP_NOTSENT_LOWAT)
+            if (notsent_low_watermark > 0
+                && socket.set_option(tcp::notsent_low_watermark(notsent_low_watermark), ec))
+                return ec;
+#endif // defined(TCP_NOTSENT_LOWAT)
+#if defined(TCP_USER_TIMEOUT)
+            if (user_timeout > 0 && socket.set_option(tcp::user_timeout(user_timeout), ec))
+                return ec;
+#endif // defined(TCP_USER_TIMEOUT)
+            if ((keep_alive_idle > 0 || keep_alive_interval > 0 || keep_alive_count > 0)
+                && socket.set_option(socket_base::keep_alive(true), ec))
+                return ec;
+#if defined(TCP_KEEPIDLE)
+            if (keep_alive_idle > 0 && socket.set_option(tcp::keep_alive_idle(keep_alive_idle), ec))
+                return ec;
+#endif // defined(TCP_KEEPIDLE)
+#if defined(TCP_KEEPINTVL)
+            if (keep_alive_interval > 0
+                && socket.set_option(tcp::keep_alive_interval(keep_alive_interval), ec))
+                return ec;
+#endif // defined(TCP_KEEPINTVL)
+#if defined(TCP_KEEPCNT)
+            if (keep_alive_count > 0 && socket.set_option(tcp::keep_alive_count(keep_alive_count), ec))
+                return ec;
+#endif // defined(TCP_KEEPCNT)
+#if defined(TCP_CONGESTION)
+            if (!congestion_control.empty()
+                && socket.set_option(tcp::congestion_control(congestion_control), ec))
+                return ec;
+#endif // defined(TCP_CONGESTION)
+            return ec;
+        }
+    };
+
+#if defined(NETWORK_HAS_TCP_INFO)
+    /**
+    * Socket option for reading the kernel's view of a connection.
+    * Implements the IPPROTO_TCP/TCP_INFO socket option, which can only be
+    * read. It reports the smoothed RTT and its variance, the congestion
+    * window, retransmits, pacing and delivery rates, and segments sent but
+    * not yet acknowledged. Fields the running kernel does not report are
+    * zero.
+    *
+    * @par Examples
+    * Getting the current values:
+    * @code
+    * NetLite::tcp::socket socket;
+    * ...
+    * NetLite::tcp::info info;
+    * socket.get_option(info);
+    * uint32_t rtt_us = info.rtt();
+    * uint32_t in_flight_segments = info.unacked();
+    * @endcode
+    *
+    * To sample many connections, see NetLite::tcp_info_sampler.
+    *
+    * @par Concepts:
+    * Socket_Option.
+    */
+    typedef NetLite::socket_option::tcp_info<NET_OS_DEF(IPPROTO_TCP), NET_OS_DEF(TCP_INFO) > info;
+#endif // defined(NETWORK_HAS_TCP_INFO)
+
 
     /// Compare two protocols for equality.
     friend bool operator==(const tcp& p1, const tcp& p2)
@@ -0,0 +1,227 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_TCP_INFO_SAMPLER_HPP
+#define NETLITE_TCP_INFO_SAMPLER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include "NetLite/config.hpp"
+
+#if defined(NETWORK_HAS_TCP_INFO)
+
+#include <cstddef>
+#include <system_error>
+#include <vector>
+#include "NetLite/socket_types.hpp"
+#include "NetLite/socket_ops.hpp"
+#include "NetLite/tcp.hpp"
+
+namespace NetLite{
+
+/**
+ * Reads tcp::info for a set of connections.
+ *
+ * The sampler keeps one result per connection and refreshes them in place,
+ * so sampling allocates nothing. refresh() can be given a budget: each call
+ * then reads the next few connections, continuing where the previous call
+ * stopped, which spreads the cost of a large set over many calls.
+ *
+ * The sampler does not own the sockets. Remove a socket before closing it,
+ * or a descriptor reused by a later connection would be read in its place.
+ *
+ * @par Example
+ * Picking the backend with the lowest smoothed RTT:
+ * @code
+ * NetLite::tcp_info_sampler sampler;
+ * for (std::size_t i = 0; i < backends.size(); ++i)
+ *     sampler.add(backends[i]);
+ * ...
+ * sampler.refresh();
+ * std::size_t best = 0;
+ * for (std::size_t i = 1; i < sampler.size(); ++i)
+ *     if (!sampler[i].error && sampler[i].info.rtt() < sampler[best].info.rtt())
+ *         best = i;
+ * @endcode
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe.
+ */
+class tcp_info_sampler
+{
+public:
+    /// The latest result for one connection.
+    struct sample
+    {
+        /// The socket it was read from.
+        socket_type socket;
+
+        /// The error from the last read, if any. info keeps its previous
+        /// values when the read fails.
+        std::error_code error;
+
+        /// The values from the last successful read.
+        tcp::info info;
+
+        /// The bytes sent but not yet acknowledged, exact where the send
+        /// queue can be read and info.unacked_bytes() elsewhere.
+        uint64_t unacked_bytes;
+    };
+
+    tcp_info_sampler()
+        : next_(0)
+    {
+    }
+
+    /// Reserve space for the given number of connections.
+    void reserve(std::size_t count)
+    {
+        samples_.reserve(count);
+    }
+
+    /// Add a connection. Its sample is all zeros until the next refresh().
+    void add(socket_type native_socket)
+    {
+        sample s;
+        s.socket = native_socket;
+        s.unacked_bytes = 0;
+        samples_.push_back(s);
+    }
+
+    /// Add a connection.
+    template <typename Holder>
+    void add(const basic_socket<tcp, Holder>& socket)
+    {
+        add(socket.native_handle());
+    }
+
+    /**
+     * Remove a connection.
+     * The last sample takes its place, so indexes of other samples may
+     * change.
+     *
+     * @returns false if the socket was not in the sampler.
+     */
+    bool remove(socket_type native_socket)
+    {
+        for (std::size_t i = 0; i < samples_.size(); ++i)
+        {
+            if (samples_[i].socket == native_socket)
+            {
+                if (i + 1 != samples_.size())
+                    samples_[i] = samples_.back();
+                samples_.pop_back();
+                if (next_ >= samples_.size())
+                    next_ = 0;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// Remove a connection.
+    template <typename Holder>
+    bool remove(const basic_socket<tcp, Holder>& socket)
+    {
+        return remove(socket.native_handle());
+    }
+
+    /// Remove all connections.
+    void clear()
+    {
+        samples_.clear();
+        next_ = 0;
+    }
+
+    /// Get the number of connections.
+    std::size_t size() const
+    {
+        return samples_.size();
+    }
+
+    /// Get the sample at the given index.
+    const sample& operator[](std::size_t index) const
+    {
+        return samples_[index];
+    }
+
+    typedef std::vector<sample>::const_iterator const_iterator;
+
+    const_iterator begin() const
+    {
+        return samples_.begin();
+    }
+
+    const_iterator end() const
+    {
+        return samples_.end();
+    }
+
+    /// Read every connection.
+    /// @returns The number of connections read without error.
+    std::size_t refresh()
+    {
+        next_ = 0;
+        return refresh(samples_.size());
+    }
+
+    /**
+     * Read up to max_count connections, starting after the last one read by
+     * the previous call and wrapping around at the end.
+     *
+     * @returns The number of connections read without error.
+     */
+    std::size_t refresh(std::size_t max_count)
+    {
+        const std::size_t count = samples_.size();
+        if (max_count > count)
+            max_count = count;
+
+        std::size_t succeeded = 0;
+        for (std::size_t n = 0; n < max_count; ++n)
+        {
+            if (next_ >= count)
+                next_ = 0;
+            // A failed getsockopt writes nothing, so the sample is read in
+            // place.
+            sample& s = samples_[next_++];
+            const tcp protocol = tcp::v4();
+            std::size_t size = s.info.size(protocol);
+            socket_ops::getsockopt(s.socket, 0, s.info.level(protocol), s.info.name(protocol),
+                s.info.data(protocol), &size, s.error);
+            if (s.error)
+                continue;
+            s.info.resize(protocol, size);
+
+            // The send queue holds what is in flight and what is not sent
+            // yet; the second part comes from the info just read.
+            std::error_code queue_ec;
+            const uint64_t queued = socket_ops::send_queue_size(s.socket, queue_ec);
+            const uint64_t notsent = s.info.notsent_bytes();
+            if (queue_ec)
+                s.unacked_bytes = s.info.unacked_bytes();
+            else
+                s.unacked_bytes = queued > notsent ? queued - notsent : 0;
+            ++succeeded;
+        }
+        return succeeded;
+    }
+
+private:
+    std::vector<sample> samples_;
+
+    // The index refresh() reads next.
+    std::size_t next_;
+};
+
+} // namespace NetLite
+
+#endif // defined(NETWORK_HAS_TCP_INFO)
+
+#endif // END OF NETLITE_TCP_INFO_SAMPLER_HPP
@@ -26,6 +26,8 @@ public:
     typedef basic_endpoint<udp> endpoint;
     /// The UDP socket type.
     typedef basic_socket<udp> socket;
+    /// The move-only UDP socket type, which stores its descriptor inline.
+    typedef basic_socket<udp, unique_socket_holder> unique_socket;
 
     udp()
         : family_(NET_OS_DEF(AF_INET))
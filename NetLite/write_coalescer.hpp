@@ -0,0 +1,207 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_WRITE_COALESCER_HPP
+#define NETLITE_WRITE_COALESCER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <cstddef>
+#include <memory>
+#include <system_error>
+#include <vector>
+#include "NetLite/config.hpp"
+#include "NetLite/socket_types.hpp"
+#include "NetLite/socket_ops.hpp"
+#include "NetLite/socket_stats.hpp"
+#include "NetLite/detail/buffer_sequence_adapter.hpp"
+
+namespace NetLite{
+
+class write_coalescer;
+
+/**
+ * The part of an io_context that flushes coalesced writes.
+ *
+ * A write_coalescer asks to be flushed once per loop iteration with
+ * schedule_flush(); the context calls write_coalescer::scheduled_flush() on
+ * it after the iteration's handlers have run. A coalescer that is destroyed
+ * while scheduled withdraws itself with cancel_flush().
+ */
+class flush_scheduler
+{
+public:
+    /// Call coalescer->scheduled_flush() at the end of the current loop
+    /// iteration.
+    virtual void schedule_flush(write_coalescer* coalescer) = 0;
+
+    /// Forget a coalescer passed to schedule_flush().
+    virtual void cancel_flush(write_coalescer* coalescer) = 0;
+
+protected:
+    ~flush_scheduler() {}
+};
+
+/**
+ * Collects the sends made on a stream socket during one loop iteration and
+ * writes them with as few system calls as possible.
+ *
+ * write() copies the data into a staging buffer and asks the scheduler for a
+ * flush at the end of the iteration, so dozens of small sends made by the
+ * handlers of one iteration leave in a single send, and in as few segments as
+ * the data allows. When the staged data would grow past the limit, it is
+ * sent right away together with the new buffers in one gathered send.
+ *
+ * The socket must be in user non-blocking mode, so that no send made by the
+ * coalescer, and in particular none made from the scheduler's loop, waits.
+ * When the socket is full, write() takes only what it could send, or fails
+ * with std::errc::operation_would_block, and the staged data never grows
+ * past the limit.
+ *
+ * With cork on, such an early send sets TCP_CORK first, so the kernel holds
+ * back partial segments until the end of the iteration, where the final
+ * flush clears it again. Cork is ignored where TCP_CORK does not exist.
+ *
+ * An error from a send that happens after write() has returned is kept and
+ * reported by the next write() or flush(); the data staged at that time is
+ * dropped.
+ *
+ * Normally used through basic_socket::enable_write_coalescing().
+ *
+ * @par Thread Safety
+ * @e Distinct @e objects: Safe.@n
+ * @e Shared @e objects: Unsafe. All calls must be made from the thread
+ * running the scheduler's loop.
+ */
+class write_coalescer
+{
+public:
+    /// The default number of bytes staged before they are sent early.
+    enum { default_limit = 65536 };
+
+    /**
+     * Construct a coalescer for a connected stream socket.
+     *
+     * @param scheduler The context that flushes the coalescer. It must
+     * outlive the coalescer.
+     *
+     * @param native_socket The socket to send on. It is not owned.
+     *
+     * @param state The socket's state, see set_state(). It must include
+     * socket_ops::user_set_non_blocking.
+     *
+     * @param cork Set TCP_CORK around sends made before the end of the
+     * iteration.
+     *
+     * @param limit The number of bytes staged before they are sent early.
+     *
+     * @param stats The counters to record sends in, or null.
+     */
+    NETWORK_API write_coalescer(flush_scheduler& scheduler, socket_type native_socket,
+        socket_ops::state_type state, bool cork = false, std::size_t limit = default_limit,
+        std::shared_ptr<socket_stats> stats = std::shared_ptr<socket_stats>());
+
+    /// Send what is staged, ignoring errors.
+    NETWORK_API ~write_coalescer();
+
+    write_coalescer(const write_coalescer&) = delete;
+    write_coalescer& operator=(const write_coalescer&) = delete;
+
+    /**
+     * Queue data to be sent at the end of the loop iteration.
+     *
+     * @param bufs The data, at most buffer_sequence_adapter_base::max_buffers
+     * buffers. What is taken is copied or sent before the function returns.
+     *
+     * @param count The number of buffers.
+     *
+     * @param total_size The sum of the buffer sizes.
+     *
+     * @param ec Set to indicate what error occurred, if any, including one
+     * kept from an earlier send. std::errc::operation_would_block means the
+     * socket is full and nothing was taken; flush() once it is writable.
+     *
+     * @returns The number of bytes taken: total_size, fewer when the socket
+     * filled up, or 0 if an error occurred.
+     */
+    NETWORK_API std::size_t write(const socket_ops::buf* bufs, std::size_t count,
+        std::size_t total_size, std::error_code& ec);
+
+    /**
+     * Send everything staged now.
+     * This stops when the socket would block, leaving the rest staged and
+     * setting ec to std::errc::operation_would_block; call it again once the
+     * socket is writable.
+     *
+     * @param ec Set to indicate what error occurred, if any, including one
+     * kept from an earlier send.
+     */
+    NETWORK_API std::error_code flush(std::error_code& ec);
+
+    /// Called by the scheduler at the end of the iteration. Errors are kept
+    /// for the next write() or flush().
+    NETWORK_API void scheduled_flush();
+
+    /// Update the socket state after the socket's non-blocking mode changed.
+    void set_state(socket_ops::state_type state)
+    {
+        state_ = state;
+    }
+
+    /// Get the number of bytes staged and not yet sent.
+    std::size_t pending() const
+    {
+        return staging_.size();
+    }
+
+    /// Determine whether TCP_CORK is used around early sends.
+    bool cork() const
+    {
+        return cork_;
+    }
+
+private:
+    // Send the buffers until they are all sent or the socket would block.
+    // Returns the number of bytes sent.
+    NETWORK_API std::size_t send_all(socket_ops::buf* bufs, std::size_t count,
+        std::size_t total_size, std::error_code& ec);
+
+    // Send everything staged, leaving error_ alone.
+    NETWORK_API void do_flush(std::error_code& ec);
+
+    NETWORK_API void set_cork(bool on, std::error_code& ec);
+
+    NETWORK_API void schedule();
+
+    NETWORK_API static const char* buf_data(const socket_ops::buf& b);
+    NETWORK_API static std::size_t buf_size(const socket_ops::buf& b);
+
+    flush_scheduler& scheduler_;
+    socket_type socket_;
+    socket_ops::state_type state_;
+    bool cork_;
+    std::size_t limit_;
+    std::shared_ptr<socket_stats> stats_;
+
+    // The data waiting to be sent.
+    std::vector<char> staging_;
+
+    // Whether the scheduler holds this coalescer, and whether TCP_CORK is
+    // set.
+    bool scheduled_;
+    bool corked_;
+
+    // The error of a send made after write() returned.
+    std::error_code error_;
+};
+
+} // namespace NetLite
+
+#include "NetLite/write_coalescer.ipp"
+
+#endif // END OF NETLITE_WRITE_COALESCER_HPP
@@ -0,0 +1,237 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_WRITE_COALESCER_IPP
+#define NETLITE_WRITE_COALESCER_IPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+# pragma once
+#endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
+
+#include <utility>
+#include "NetLite/write_coalescer.hpp"
+
+namespace NetLite{
+
+write_coalescer::write_coalescer(flush_scheduler& scheduler, socket_type native_socket,
+    socket_ops::state_type state, bool cork, std::size_t limit,
+    std::shared_ptr<socket_stats> stats)
+    : scheduler_(scheduler)
+    , socket_(native_socket)
+    , state_(state)
+    , cork_(cork)
+    , limit_(limit)
+    , stats_(std::move(stats))
+    , scheduled_(false)
+    , corked_(false)
+{
+}
+
+write_coalescer::~write_coalescer()
+{
+    if (scheduled_)
+        scheduler_.cancel_flush(this);
+    std::error_code ignored_ec;
+    do_flush(ignored_ec);
+}
+
+std::size_t write_coalescer::write(const socket_ops::buf* bufs, std::size_t count,
+    std::size_t total_size, std::error_code& ec)
+{
+    if (error_)
+    {
+        ec = error_;
+        error_ = std::error_code();
+        return 0;
+    }
+    ec = std::error_code();
+    if (total_size == 0)
+        return 0;
+
+    if (staging_.size() + total_size <= limit_)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            staging_.insert(staging_.end(), buf_data(bufs[i]), buf_data(bufs[i]) + buf_size(bufs[i]));
+        schedule();
+        return total_size;
+    }
+
+    // Too much for one iteration: send the staged data and the new buffers
+    // together now. With cork on, the kernel keeps the last partial segment
+    // back until the end of the iteration.
+    if (cork_ && !corked_)
+    {
+        std::error_code ignored_ec;
+        set_cork(true, ignored_ec);
+    }
+
+    socket_ops::buf gather[buffer_sequence_adapter_base::max_buffers + 1];
+    std::size_t n = 0;
+    const std::size_t staged = staging_.size();
+    if (staged != 0)
+        socket_ops::init_buf(gather[n++], &staging_[0], staged);
+    for (std::size_t i = 0; i < count; ++i)
+        gather[n++] = bufs[i];
+    std::size_t sent = send_all(gather, n, staged + total_size, ec);
+
+    if (sent >= staged)
+    {
+        staging_.clear();
+        sent -= staged;
+    }
+    else
+    {
+        staging_.erase(staging_.begin(), staging_.begin() + sent);
+        sent = 0;
+    }
+
+    if (ec && ec != std::errc::operation_would_block
+        && ec != std::errc::resource_unavailable_try_again)
+    {
+        staging_.clear();
+        return 0;
+    }
+
+    // The uncork, or the rest of the staged data, goes out at the end of the
+    // iteration.
+    if (corked_ || !staging_.empty())
+        schedule();
+
+    if (ec)
+    {
+        // The socket is full. Of the new data only what was sent is taken,
+        // as with a non-blocking send, so that staging stays within the
+        // limit and the caller sees the backpressure.
+        if (sent != 0)
+            ec = std::error_code();
+        return sent;
+    }
+    return total_size;
+}
+
+std::error_code write_coalescer::flush(std::error_code& ec)
+{
+    if (error_)
+    {
+        ec = error_;
+        error_ = std::error_code();
+        return ec;
+    }
+    do_flush(ec);
+    return ec;
+}
+
+void write_coalescer::scheduled_flush()
+{
+    scheduled_ = false;
+    if (error_)
+        return;
+    std::error_code ec;
+    do_flush(ec);
+    if (ec && ec != std::errc::operation_would_block
+        && ec != std::errc::resource_unavailable_try_again)
+        error_ = ec;
+}
+
+void write_coalescer::do_flush(std::error_code& ec)
+{
+    ec = std::error_code();
+    if (!staging_.empty())
+    {
+        socket_ops::buf b;
+        socket_ops::init_buf(b, &staging_[0], staging_.size());
+        const std::size_t sent = send_all(&b, 1, staging_.size(), ec);
+        if (ec == std::errc::operation_would_block
+            || ec == std::errc::resource_unavailable_try_again)
+        {
+            staging_.erase(staging_.begin(), staging_.begin() + sent);
+            return;
+        }
+        staging_.clear();
+    }
+
+    // Everything is out, so the last partial segment can go too.
+    if (corked_)
+    {
+        std::error_code ignored_ec;
+        set_cork(false, ignored_ec);
+        corked_ = false;
+    }
+}
+
+std::size_t write_coalescer::send_all(socket_ops::buf* bufs, std::size_t count,
+    std::size_t total_size, std::error_code& ec)
+{
+    std::size_t done = 0;
+    while (done < total_size)
+    {
+        std::size_t n = socket_ops::sync_send(socket_, state_, bufs, count, 0, false, ec);
+        if (stats_)
+            stats_->record_send(total_size - done, n, ec);
+        if (ec)
+        {
+            if (ec == std::errc::interrupted)
+                continue;
+            return done;
+        }
+        done += n;
+
+        // Drop what was sent from the front of the list.
+        while (count != 0 && n >= buf_size(*bufs))
+        {
+            n -= buf_size(*bufs);
+            ++bufs;
+            --count;
+        }
+        if (n != 0)
+            socket_ops::init_buf(*bufs, buf_data(*bufs) + n, buf_size(*bufs) - n);
+    }
+    return done;
+}
+
+void write_coalescer::set_cork(bool on, std::error_code& ec)
+{
+#if defined(TCP_CORK)
+    int value = on ? 1 : 0;
+    socket_ops::setsockopt(socket_, state_, IPPROTO_TCP, TCP_CORK, &value, sizeof(value), ec);
+    if (!ec)
+        corked_ = on;
+#else // defined(TCP_CORK)
+    (void)on;
+    ec = std::error_code();
+#endif // defined(TCP_CORK)
+}
+
+void write_coalescer::schedule()
+{
+    if (!scheduled_)
+    {
+        scheduled_ = true;
+        scheduler_.schedule_flush(this);
+    }
+}
+
+const char* write_coalescer::buf_data(const socket_ops::buf& b)
+{
+#if defined(_WIN32) || defined(__CYGWIN__)
+    return b.buf;
+#else // defined(_WIN32) || defined(__CYGWIN__)
+    return static_cast<const char*>(b.iov_base);
+#endif // defined(_WIN32) || defined(__CYGWIN__)
+}
+
+std::size_t write_coalescer::buf_size(const socket_ops::buf& b)
+{
+#if defined(_WIN32) || defined(__CYGWIN__)
+    return b.len;
+#else // defined(_WIN32) || defined(__CYGWIN__)
+    return b.iov_len;
+#endif // defined(_WIN32) || defined(__CYGWIN__)
+}
+
+} // namespace NetLite
+
+#endif // END OF NETLITE_WRITE_COALESCER_IPP
@@ -0,0 +1,304 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#include <poll.h>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "NetLite/tcp.hpp"
+#if defined(NETWORK_HAS_IO_URING)
+# include "NetLite/io_services/io_uring_io_context.hpp"
+#endif // defined(NETWORK_HAS_IO_URING)
+#include "bench.hpp"
+
+namespace bench{
+namespace{
+
+using NetLite::tcp;
+
+// A listening socket on an ephemeral loopback port that accepts and
+// immediately closes every connection, recording when the last one came in.
+class storm_server
+{
+public:
+    storm_server()
+        : accepted_(0)
+        , last_accept_ns_(0)
+    {
+        acceptor_.open();
+        acceptor_.set_option(NetLite::socket_base::reuse_address(true));
+        acceptor_.bind(tcp::endpoint(NetLite::ip::address::from_string("127.0.0.1"), 0));
+        acceptor_.listen();
+        endpoint_ = acceptor_.local_endpoint();
+    }
+
+    virtual ~storm_server()
+    {
+    }
+
+    const tcp::endpoint& endpoint() const
+    {
+        return endpoint_;
+    }
+
+    uint64_t accepted() const
+    {
+        return accepted_.load(std::memory_order_acquire);
+    }
+
+    uint64_t last_accept_ns() const
+    {
+        return last_accept_ns_.load(std::memory_order_acquire);
+    }
+
+protected:
+    // Only called from the server's own thread.
+    void on_accept(std::size_t count)
+    {
+        last_accept_ns_.store(now_ns(), std::memory_order_relaxed);
+        accepted_.store(accepted_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    tcp::socket acceptor_;
+    tcp::endpoint endpoint_;
+
+private:
+    std::atomic<uint64_t> accepted_;
+    std::atomic<uint64_t> last_accept_ns_;
+};
+
+// accept() in a loop on a blocking socket.
+class blocking_storm_server : public storm_server
+{
+public:
+    blocking_storm_server()
+        : stop_(false)
+    {
+        thread_ = std::thread([this]()
+        {
+            while (!stop_.load(std::memory_order_relaxed))
+            {
+                tcp::endpoint peer_endpoint;
+                std::error_code ec;
+                tcp::socket peer = acceptor_.accept(peer_endpoint, ec);
+                if (!ec)
+                    on_accept(1);
+            }
+        });
+    }
+
+    ~blocking_storm_server()
+    {
+        stop_.store(true);
+        std::error_code ec;
+        acceptor_.shutdown(NetLite::socket_base::shutdown_receive, ec);
+        thread_.join();
+    }
+
+private:
+    std::atomic<bool> stop_;
+    std::thread thread_;
+};
+
+// Wait for readiness, then drain the backlog with accept_batch().
+class batch_storm_server : public storm_server
+{
+public:
+    batch_storm_server()
+        : stop_(false)
+    {
+        thread_ = std::thread([this]()
+        {
+            std::vector<std::pair<tcp::socket, tcp::endpoint> > peers;
+            peers.reserve(64);
+            while (!stop_.load(std::memory_order_relaxed))
+            {
+                pollfd fd;
+                fd.fd = acceptor_.native_handle();
+                fd.events = POLLIN;
+                fd.revents = 0;
+                if (::poll(&fd, 1, 10) <= 0)
+                    continue;
+                std::error_code ec;
+                std::size_t n = acceptor_.accept_batch(peers, 64, ec);
+                if (n != 0)
+                    on_accept(n);
+                peers.clear();
+            }
+        });
+    }
+
+    ~batch_storm_server()
+    {
+        stop_.store(true);
+        thread_.join();
+    }
+
+private:
+    std::atomic<bool> stop_;
+    std::thread thread_;
+};
+
+#if defined(NETWORK_HAS_IO_URING)
+
+// A multishot accept on an io_uring_io_context thread.
+class io_uring_storm_server : public storm_server
+{
+public:
+    io_uring_storm_server()
+        : io_(1024)
+    {
+        io_.async_accept(acceptor_, [this](const std::error_code& ec, tcp::socket)
+        {
+            if (!ec)
+                on_accept(1);
+        });
+        thread_ = std::thread([this]()
+        {
+            std::error_code ec;
+            io_.run(ec);
+        });
+    }
+
+    ~io_uring_storm_server()
+    {
+        io_.stop();
+        thread_.join();
+    }
+
+private:
+    NetLite::io_uring_io_context io_;
+    std::thread thread_;
+};
+
+#endif // defined(NETWORK_HAS_IO_URING)
+
+std::unique_ptr<storm_server> start_storm_server(const std::string& backend)
+{
+    try
+    {
+        if (backend == "blocking")
+            return std::unique_ptr<storm_server>(new blocking_storm_server());
+        if (backend == "accept_batch")
+            return std::unique_ptr<storm_server>(new batch_storm_server());
+#if defined(NETWORK_HAS_IO_URING)
+        if (backend == "io_uring")
+            return std::unique_ptr<storm_server>(new io_uring_storm_server());
+#endif // defined(NETWORK_HAS_IO_URING)
+    }
+    catch (const std::system_error& e)
+    {
+        std::printf("%-14s skipped: %s\n", backend.c_str(), e.what());
+    }
+    return std::unique_ptr<storm_server>();
+}
+
+// Open, connect and close count connections one after another. Closing
+// with a zero linger resets the connection instead of leaving it in
+// TIME_WAIT, so a storm does not run out of ephemeral ports.
+void storm_client(const tcp::endpoint& endpoint, std::size_t count,
+    const std::atomic<bool>& go, histogram& connect_time, std::size_t& failures)
+{
+    while (!go.load(std::memory_order_acquire))
+        std::this_thread::yield();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        tcp::socket socket;
+        std::error_code ec;
+        socket.open(tcp::v4(), ec);
+        if (!ec)
+            socket.set_option(NetLite::socket_base::linger(true, 0), ec);
+        if (ec)
+        {
+            ++failures;
+            continue;
+        }
+        uint64_t start = now_ns();
+        socket.connect(endpoint, ec);
+        uint64_t elapsed = now_ns() - start;
+        if (ec)
+            ++failures;
+        else
+            connect_time.record(elapsed);
+    }
+}
+
+} // namespace
+
+int run_accept_storm(const options& opts)
+{
+    std::vector<std::size_t> connectors = opts.connections;
+    if (connectors.empty())
+        connectors = { 1, 8 };
+
+    std::vector<std::string> backends;
+    backends.push_back("blocking");
+    backends.push_back("accept_batch");
+#if defined(NETWORK_HAS_IO_URING)
+    backends.push_back("io_uring");
+#endif // defined(NETWORK_HAS_IO_URING)
+
+    std::printf("%-14s %10s %9s %9s %12s %9s %9s %9s  (usec)\n", "backend", "connectors",
+        "accepted", "failed", "accepts/s", "p50", "p99", "max");
+    for (const std::string& backend : backends)
+    {
+        if (!opts.wants_backend(backend))
+            continue;
+        for (std::size_t connector_count : connectors)
+        {
+            std::unique_ptr<storm_server> server = start_storm_server(backend);
+            if (!server)
+                break;
+
+            std::atomic<bool> go(false);
+            std::vector<histogram> connect_times(connector_count);
+            std::vector<std::size_t> failures(connector_count, 0);
+            std::vector<std::thread> threads;
+            for (std::size_t i = 0; i < connector_count; ++i)
+            {
+                std::size_t count = opts.count / connector_count + (i < opts.count % connector_count ? 1 : 0);
+                threads.push_back(std::thread(storm_client, std::cref(server->endpoint()), count,
+                    std::cref(go), std::ref(connect_times[i]), std::ref(failures[i])));
+            }
+
+            uint64_t start = now_ns();
+            go.store(true, std::memory_order_release);
+            for (std::size_t i = 0; i < threads.size(); ++i)
+                threads[i].join();
+
+            histogram connect_time;
+            std::size_t failed = 0;
+            for (std::size_t i = 0; i < connector_count; ++i)
+            {
+                connect_time.merge(connect_times[i]);
+                failed += failures[i];
+            }
+
+            // Every connect that succeeded is in the backlog by now; give the
+            // server a moment to take the rest.
+            uint64_t expected = connect_time.count();
+            for (unsigned waited = 0; server->accepted() < expected && waited < 5000; ++waited)
+                sleep_ms(1);
+            uint64_t accepted = server->accepted();
+            double seconds = static_cast<double>(server->last_accept_ns() - start) / 1e9;
+            server.reset();
+
+            std::printf("%-14s %10zu %9llu %9zu %12.0f %9.2f %9.2f %9.2f\n", backend.c_str(),
+                connector_count, static_cast<unsigned long long>(accepted), failed,
+                seconds > 0 ? static_cast<double>(accepted) / seconds : 0.0,
+                connect_time.percentile(50) / 1e3, connect_time.percentile(99) / 1e3,
+                connect_time.max() / 1e3);
+            std::fflush(stdout);
+        }
+    }
+    return 0;
+}
+
+} // namespace bench
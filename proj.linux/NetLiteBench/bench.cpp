@@ -0,0 +1,32 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#include "NetLite/config.hpp"
+#include "bench.hpp"
+
+namespace bench{
+
+std::vector<std::string> available_backends()
+{
+    std::vector<std::string> backends;
+    backends.push_back("blocking");
+#if defined(NETWORK_HAS_IO_URING)
+    backends.push_back("io_uring");
+    backends.push_back("io_uring-pool");
+#endif // defined(NETWORK_HAS_IO_URING)
+    return backends;
+}
+
+std::string format_size(std::size_t bytes)
+{
+    if (bytes >= (1 << 20) && bytes % (1 << 20) == 0)
+        return std::to_string(bytes >> 20) + "M";
+    if (bytes >= (1 << 10) && bytes % (1 << 10) == 0)
+        return std::to_string(bytes >> 10) + "K";
+    return std::to_string(bytes);
+}
+
+} // namespace bench
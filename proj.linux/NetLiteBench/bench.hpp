@@ -0,0 +1,225 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_BENCH_HPP
+#define NETLITE_BENCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace bench{
+
+/// Monotonic time in nanoseconds.
+inline uint64_t now_ns()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline void sleep_ms(unsigned ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+/// Determine whether an error only means a non-blocking call found nothing
+/// to do.
+inline bool would_block(const std::error_code& ec)
+{
+    return ec == std::errc::operation_would_block || ec == std::errc::resource_unavailable_try_again;
+}
+
+/**
+ * A latency histogram in the style of HdrHistogram.
+ *
+ * Values below 128 are counted exactly. Above that every power of two is
+ * split into 64 linear sub-buckets, so any recorded value is reported with
+ * less than 1.6% error while the whole 64-bit range fits in a fixed array.
+ * Recording is a few instructions and never allocates, so it can sit on the
+ * measured path.
+ */
+class histogram
+{
+public:
+    histogram()
+        : counts_(bucket_count, 0)
+        , total_(0)
+        , min_(UINT64_MAX)
+        , max_(0)
+        , sum_(0)
+    {
+    }
+
+    void record(uint64_t value)
+    {
+        ++counts_[index_of(value)];
+        ++total_;
+        sum_ += value;
+        if (value < min_)
+            min_ = value;
+        if (value > max_)
+            max_ = value;
+    }
+
+    void merge(const histogram& other)
+    {
+        for (std::size_t i = 0; i < bucket_count; ++i)
+            counts_[i] += other.counts_[i];
+        total_ += other.total_;
+        sum_ += other.sum_;
+        if (other.min_ < min_)
+            min_ = other.min_;
+        if (other.max_ > max_)
+            max_ = other.max_;
+    }
+
+    uint64_t count() const
+    {
+        return total_;
+    }
+
+    uint64_t min() const
+    {
+        return total_ ? min_ : 0;
+    }
+
+    uint64_t max() const
+    {
+        return max_;
+    }
+
+    double mean() const
+    {
+        return total_ ? static_cast<double>(sum_) / static_cast<double>(total_) : 0.0;
+    }
+
+    /// The highest value that the given percentage of samples do not exceed.
+    uint64_t percentile(double percent) const
+    {
+        if (total_ == 0)
+            return 0;
+        uint64_t wanted = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(total_) + 0.5);
+        if (wanted == 0)
+            wanted = 1;
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < bucket_count; ++i)
+        {
+            seen += counts_[i];
+            if (seen >= wanted)
+            {
+                uint64_t value = highest_of(i);
+                return value < max_ ? value : max_;
+            }
+        }
+        return max_;
+    }
+
+private:
+    enum
+    {
+        exact_count = 128,
+        sub_bucket_count = 64,
+        bucket_count = exact_count + 57 * sub_bucket_count
+    };
+
+    static std::size_t index_of(uint64_t value)
+    {
+        if (value < exact_count)
+            return static_cast<std::size_t>(value);
+        unsigned shift = 63 - static_cast<unsigned>(__builtin_clzll(value)) - 6;
+        return exact_count + (shift - 1) * sub_bucket_count
+            + static_cast<std::size_t>((value >> shift) - sub_bucket_count);
+    }
+
+    static uint64_t highest_of(std::size_t index)
+    {
+        if (index < exact_count)
+            return index;
+        std::size_t shift = (index - exact_count) / sub_bucket_count + 1;
+        uint64_t sub = (index - exact_count) % sub_bucket_count + sub_bucket_count;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_;
+    uint64_t min_;
+    uint64_t max_;
+    uint64_t sum_;
+};
+
+/// Settings shared by every benchmark, from the command line.
+struct options
+{
+    /// How long each configuration is measured, in milliseconds.
+    unsigned duration_ms;
+
+    /// How long each configuration runs before measuring starts.
+    unsigned warmup_ms;
+
+    /// Connection counts to sweep. Empty means the benchmark's default.
+    std::vector<std::size_t> connections;
+
+    /// Message sizes to sweep, in bytes. Empty means the benchmark's default.
+    std::vector<std::size_t> sizes;
+
+    /// Messages each connection keeps in flight in throughput runs.
+    std::size_t depth;
+
+    /// Receive batch sizes to sweep. Empty means the benchmark's default.
+    std::vector<std::size_t> batches;
+
+    /// Connections opened by a connection storm.
+    std::size_t count;
+
+    /// Backends to run. Empty means all that are available.
+    std::vector<std::string> backends;
+
+    options()
+        : duration_ms(1000)
+        , warmup_ms(200)
+        , depth(16)
+        , count(100000)
+    {
+    }
+
+    bool wants_backend(const std::string& name) const
+    {
+        if (backends.empty())
+            return true;
+        for (std::size_t i = 0; i < backends.size(); ++i)
+        {
+            if (backends[i] == name)
+                return true;
+        }
+        return false;
+    }
+};
+
+/// The backends this build can run, in the order they are reported.
+std::vector<std::string> available_backends();
+
+/// Format a byte count with a binary suffix, e.g. 64, 4K, 1M.
+std::string format_size(std::size_t bytes);
+
+/// TCP echo throughput over loopback.
+int run_tcp_echo(const options& opts);
+
+/// TCP request/response latency over loopback.
+int run_tcp_pingpong(const options& opts);
+
+/// UDP datagrams per second over loopback.
+int run_udp_pps(const options& opts);
+
+/// Accept rate under a storm of short-lived connections.
+int run_accept_storm(const options& opts);
+
+} // namespace bench
+
+#endif // END OF NETLITE_BENCH_HPP
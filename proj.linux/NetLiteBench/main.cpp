@@ -0,0 +1,169 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+
+namespace{
+
+struct benchmark_entry
+{
+    const char* name;
+    int (*run)(const bench::options&);
+    const char* description;
+};
+
+const benchmark_entry benchmarks[] =
+{
+    { "tcp-echo", bench::run_tcp_echo, "TCP echo throughput over loopback" },
+    { "tcp-pingpong", bench::run_tcp_pingpong, "TCP request/response latency over loopback" },
+    { "udp-pps", bench::run_udp_pps, "UDP datagrams per second over loopback" },
+    { "accept-storm", bench::run_accept_storm, "accept rate under short-lived connections" },
+};
+
+void usage(const char* program)
+{
+    std::cerr << "usage: " << program << " <benchmark>|all [options]\n\n"
+        << "benchmarks:\n";
+    for (const benchmark_entry& b : benchmarks)
+        std::cerr << "  " << b.name << std::string(16 - std::strlen(b.name), ' ') << b.description << "\n";
+    std::cerr << "\noptions:\n"
+        << "  --duration <ms>       measured time per configuration (default 1000)\n"
+        << "  --warmup <ms>         unmeasured time before each configuration (default 200)\n"
+        << "  --connections <list>  connection counts, e.g. 1,4,16; senders for udp-pps,\n"
+        << "                        concurrent connectors for accept-storm\n"
+        << "  --sizes <list>        message sizes, e.g. 64,4K,1M\n"
+        << "  --depth <n>           messages in flight per connection (default 16)\n"
+        << "  --batch <list>        datagrams drained per wakeup in udp-pps, e.g. 1,8,32\n"
+        << "  --count <n>           connections opened by accept-storm (default 100000)\n"
+        << "  --backend <list>      backends to run:";
+    std::vector<std::string> backends = bench::available_backends();
+    for (std::size_t i = 0; i < backends.size(); ++i)
+        std::cerr << (i ? "," : " ") << backends[i];
+    std::cerr << std::endl;
+}
+
+std::size_t parse_size(const std::string& text)
+{
+    char* end = 0;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str())
+        throw std::invalid_argument("bad number: " + text);
+    if (*end == 'K' || *end == 'k')
+        value <<= 10, ++end;
+    else if (*end == 'M' || *end == 'm')
+        value <<= 20, ++end;
+    if (*end != '\0')
+        throw std::invalid_argument("bad number: " + text);
+    return static_cast<std::size_t>(value);
+}
+
+std::vector<std::string> split_list(const std::string& text)
+{
+    std::vector<std::string> items;
+    std::istringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ','))
+    {
+        if (!item.empty())
+            items.push_back(item);
+    }
+    return items;
+}
+
+std::vector<std::size_t> parse_size_list(const std::string& text)
+{
+    std::vector<std::size_t> values;
+    for (const std::string& item : split_list(text))
+        values.push_back(parse_size(item));
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // A peer that closes first must not kill the process.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    try
+    {
+        bench::options opts;
+        for (int i = 2; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                usage(argv[0]);
+                return 2;
+            }
+            std::string value = argv[++i];
+            if (arg == "--duration")
+                opts.duration_ms = static_cast<unsigned>(parse_size(value));
+            else if (arg == "--warmup")
+                opts.warmup_ms = static_cast<unsigned>(parse_size(value));
+            else if (arg == "--connections")
+                opts.connections = parse_size_list(value);
+            else if (arg == "--sizes")
+                opts.sizes = parse_size_list(value);
+            else if (arg == "--depth")
+                opts.depth = parse_size(value);
+            else if (arg == "--batch")
+                opts.batches = parse_size_list(value);
+            else if (arg == "--count")
+                opts.count = parse_size(value);
+            else if (arg == "--backend")
+                opts.backends = split_list(value);
+            else
+            {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+
+        if (opts.depth == 0)
+            opts.depth = 1;
+
+        std::string name = argv[1];
+        int result = 0;
+        bool found = false;
+        for (const benchmark_entry& b : benchmarks)
+        {
+            if (name == "all" || name == b.name)
+            {
+                found = true;
+                std::cout << "== " << b.name << " ==" << std::endl;
+                result |= b.run(opts);
+                std::cout << std::endl;
+            }
+        }
+        if (!found)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        return result;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+}
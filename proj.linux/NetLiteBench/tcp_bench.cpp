@@ -0,0 +1,485 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#include <poll.h>
+#include <atomic>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "NetLite/tcp.hpp"
+#include "NetLite/mutablebuf.hpp"
+#if defined(NETWORK_HAS_IO_URING)
+# include "NetLite/buffer_pool.hpp"
+# include "NetLite/io_services/io_uring_io_context.hpp"
+#endif // defined(NETWORK_HAS_IO_URING)
+#include "bench.hpp"
+
+namespace bench{
+namespace{
+
+using NetLite::tcp;
+
+// Send the whole range, blocking or spinning as the socket's mode dictates.
+bool send_all(tcp::socket& socket, const char* data, std::size_t size, std::error_code& ec)
+{
+    while (size > 0)
+    {
+        std::size_t n = socket.send(NetLite::constbuf(data, size), 0, ec);
+        if (ec)
+            return false;
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Send a request on a blocking socket and receive a reply of the buffer's
+// size. Large requests are interleaved with receives so that neither side
+// stalls on a full window; small ones cost a send and a blocking receive.
+// The views into the buffer share its holder, so no receive allocates.
+bool exchange(tcp::socket& socket, const char* data, std::size_t size,
+    const NetLite::mutablebuf& buffer, std::error_code& ec)
+{
+    std::size_t sent = 0;
+    std::size_t received = 0;
+    while (received < buffer.size())
+    {
+        bool progress = false;
+        if (sent < size)
+        {
+            std::size_t n = socket.send(NetLite::constbuf(data + sent, size - sent), MSG_DONTWAIT, ec);
+            if (!ec)
+            {
+                sent += n;
+                progress = true;
+            }
+            else if (!would_block(ec))
+                return false;
+        }
+
+        NetLite::socket_base::message_flags flags = sent < size ? MSG_DONTWAIT : 0;
+        std::size_t n = socket.receive(NetLite::mutablebuf(buffer, received, buffer.size() - received), ec, flags);
+        if (!ec)
+        {
+            if (n == 0)
+            {
+                ec = std::make_error_code(std::errc::connection_reset);
+                return false;
+            }
+            received += n;
+            progress = true;
+        }
+        else if (!would_block(ec))
+            return false;
+
+        if (!progress)
+        {
+            pollfd fd;
+            fd.fd = socket.native_handle();
+            fd.events = POLLIN | POLLOUT;
+            fd.revents = 0;
+            ::poll(&fd, 1, 10);
+        }
+    }
+    return true;
+}
+
+void open_listener(tcp::socket& acceptor, tcp::endpoint& endpoint)
+{
+    acceptor.open();
+    acceptor.set_option(NetLite::socket_base::reuse_address(true));
+    acceptor.bind(tcp::endpoint(NetLite::ip::address::from_string("127.0.0.1"), 0));
+    acceptor.listen();
+    endpoint = acceptor.local_endpoint();
+}
+
+// An echo server on an ephemeral loopback port that serves a known number of
+// connections and stops once they are gone.
+class echo_server
+{
+public:
+    virtual ~echo_server()
+    {
+    }
+
+    const tcp::endpoint& endpoint() const
+    {
+        return endpoint_;
+    }
+
+protected:
+    tcp::socket acceptor_;
+    tcp::endpoint endpoint_;
+};
+
+// One thread per connection on blocking sockets.
+class blocking_echo_server : public echo_server
+{
+public:
+    explicit blocking_echo_server(std::size_t connections)
+    {
+        open_listener(acceptor_, endpoint_);
+        acceptor_thread_ = std::thread([this, connections]()
+        {
+            for (std::size_t i = 0; i < connections; ++i)
+            {
+                tcp::endpoint peer_endpoint;
+                std::error_code ec;
+                tcp::socket peer = acceptor_.accept(peer_endpoint, ec);
+                if (ec)
+                    return;
+                peer.set_option(tcp::no_delay(true), ec);
+                peer_threads_.push_back(std::thread(&blocking_echo_server::serve, std::move(peer)));
+            }
+        });
+    }
+
+    ~blocking_echo_server()
+    {
+        // Wake the acceptor if a client never showed up.
+        std::error_code ec;
+        acceptor_.shutdown(NetLite::socket_base::shutdown_receive, ec);
+        acceptor_thread_.join();
+        for (std::size_t i = 0; i < peer_threads_.size(); ++i)
+            peer_threads_[i].join();
+    }
+
+private:
+    static void serve(tcp::socket peer)
+    {
+        std::vector<char> storage(256 * 1024);
+        NetLite::mutablebuf buffer(storage.data(), storage.size());
+        for (;;)
+        {
+            std::error_code ec;
+            std::size_t n = peer.receive(buffer, ec);
+            if (ec || n == 0 || !send_all(peer, storage.data(), n, ec))
+                return;
+        }
+    }
+
+    std::thread acceptor_thread_;
+    std::vector<std::thread> peer_threads_;
+};
+
+#if defined(NETWORK_HAS_IO_URING)
+
+// All connections on one io_uring_io_context thread. Echoes are sent with a
+// blocking send from the receive handler.
+class io_uring_echo_server : public echo_server
+{
+public:
+    io_uring_echo_server(std::size_t connections, bool pooled)
+        : pool_()
+        , io_(1024)
+        , pooled_(pooled)
+        , group_(0)
+    {
+        open_listener(acceptor_, endpoint_);
+        if (!pooled_)
+            group_ = io_.add_buffer_group(1024, NetLite::buffer_pool::medium_block_size);
+
+        io_.async_accept(acceptor_, [this, connections](const std::error_code& ec, tcp::socket peer)
+        {
+            if (ec)
+                return;
+            std::error_code ignored_ec;
+            peer.set_option(tcp::no_delay(true), ignored_ec);
+            peers_.push_back(std::move(peer));
+            start_echo(peers_.back());
+            if (peers_.size() == connections)
+                io_.cancel(acceptor_);
+        });
+        thread_ = std::thread([this]()
+        {
+            std::error_code ec;
+            io_.run(ec);
+        });
+    }
+
+    ~io_uring_echo_server()
+    {
+        io_.stop();
+        thread_.join();
+    }
+
+private:
+    void start_echo(tcp::socket& peer)
+    {
+        if (pooled_)
+        {
+            io_.async_receive(peer, pool_, [&peer](const std::error_code& ec, NetLite::mutablebuf buffer)
+            {
+                std::error_code send_ec;
+                if (!ec && buffer.size() != 0)
+                    send_all(peer, buffer.c_str(), buffer.size(), send_ec);
+            });
+        }
+        else
+        {
+            io_.async_receive(peer, group_, [&peer](const std::error_code& ec, const char* data, std::size_t size)
+            {
+                std::error_code send_ec;
+                if (!ec && size != 0)
+                    send_all(peer, data, size, send_ec);
+            });
+        }
+    }
+
+    NetLite::buffer_pool pool_;
+    NetLite::io_uring_io_context io_;
+    bool pooled_;
+    unsigned short group_;
+    std::list<tcp::socket> peers_;
+    std::thread thread_;
+};
+
+#endif // defined(NETWORK_HAS_IO_URING)
+
+std::unique_ptr<echo_server> make_echo_server(const std::string& backend, std::size_t connections)
+{
+    if (backend == "blocking")
+        return std::unique_ptr<echo_server>(new blocking_echo_server(connections));
+#if defined(NETWORK_HAS_IO_URING)
+    if (backend == "io_uring")
+        return std::unique_ptr<echo_server>(new io_uring_echo_server(connections, false));
+    if (backend == "io_uring-pool")
+        return std::unique_ptr<echo_server>(new io_uring_echo_server(connections, true));
+#endif // defined(NETWORK_HAS_IO_URING)
+    return std::unique_ptr<echo_server>();
+}
+
+// Start a server for the backend, or explain why it cannot run.
+std::unique_ptr<echo_server> start_server(const std::string& backend, std::size_t connections)
+{
+    try
+    {
+        return make_echo_server(backend, connections);
+    }
+    catch (const std::system_error& e)
+    {
+        std::printf("%-14s skipped: %s\n", backend.c_str(), e.what());
+        return std::unique_ptr<echo_server>();
+    }
+}
+
+std::vector<tcp::socket> connect_clients(const tcp::endpoint& endpoint, std::size_t connections)
+{
+    std::vector<tcp::socket> clients(connections);
+    for (std::size_t i = 0; i < connections; ++i)
+    {
+        clients[i].open();
+        clients[i].connect(endpoint);
+        clients[i].set_option(tcp::no_delay(true));
+    }
+    return clients;
+}
+
+// One connection of a throughput run: keep up to depth messages in flight
+// and count the echoed bytes, until told to stop.
+void echo_client(tcp::socket& socket, std::size_t size, std::size_t depth,
+    const std::atomic<bool>& done, std::atomic<uint64_t>& received_bytes)
+{
+    std::error_code ec;
+    socket.non_blocking(true, ec);
+
+    std::vector<char> out(size, 'x');
+    std::vector<char> in(size < 256 * 1024 ? size : 256 * 1024);
+    NetLite::mutablebuf in_buffer(in.data(), in.size());
+    const uint64_t window = static_cast<uint64_t>(size) * depth;
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    std::size_t out_offset = 0;
+
+    while (!done.load(std::memory_order_relaxed))
+    {
+        bool progress = false;
+        if (sent - received < window)
+        {
+            std::size_t n = socket.send(NetLite::constbuf(out.data() + out_offset, size - out_offset), 0, ec);
+            if (!ec)
+            {
+                sent += n;
+                out_offset = (out_offset + n) % size;
+                progress = true;
+            }
+            else if (!would_block(ec))
+                return;
+        }
+
+        std::size_t n = socket.receive(in_buffer, ec);
+        if (!ec)
+        {
+            if (n == 0)
+                return;
+            received += n;
+            received_bytes.store(received, std::memory_order_relaxed);
+            progress = true;
+        }
+        else if (!would_block(ec))
+            return;
+
+        if (!progress)
+        {
+            pollfd fd;
+            fd.fd = socket.native_handle();
+            fd.events = POLLIN | (sent - received < window ? POLLOUT : 0);
+            fd.revents = 0;
+            ::poll(&fd, 1, 10);
+        }
+    }
+}
+
+// One connection of a latency run: send a message, wait for all of it to
+// come back, and record the round trip.
+void pingpong_client(tcp::socket& socket, std::size_t size,
+    const std::atomic<bool>& measuring, const std::atomic<bool>& done, histogram& latency)
+{
+    std::vector<char> out(size, 'x');
+    std::vector<char> in(size);
+    NetLite::mutablebuf in_buffer(in.data(), in.size());
+    std::error_code ec;
+    while (!done.load(std::memory_order_relaxed))
+    {
+        uint64_t start = now_ns();
+        if (!exchange(socket, out.data(), out.size(), in_buffer, ec))
+            return;
+        uint64_t elapsed = now_ns() - start;
+        if (measuring.load(std::memory_order_relaxed))
+            latency.record(elapsed);
+    }
+}
+
+} // namespace
+
+int run_tcp_echo(const options& opts)
+{
+    std::vector<std::size_t> connections = opts.connections;
+    if (connections.empty())
+        connections = { 1, 4, 16 };
+    std::vector<std::size_t> sizes = opts.sizes;
+    if (sizes.empty())
+        sizes = { 64, 1024, 16 * 1024, 1024 * 1024 };
+
+    std::printf("%-14s %6s %6s %6s %14s %12s\n", "backend", "conns", "size", "depth", "msgs/s", "MiB/s");
+    for (const std::string& backend : available_backends())
+    {
+        if (!opts.wants_backend(backend))
+            continue;
+        for (std::size_t conns : connections)
+        {
+            for (std::size_t size : sizes)
+            {
+                std::unique_ptr<echo_server> server = start_server(backend, conns);
+                if (!server)
+                    break;
+                std::vector<tcp::socket> clients = connect_clients(server->endpoint(), conns);
+
+                std::atomic<bool> done(false);
+                std::vector<std::atomic<uint64_t> > received(conns);
+                std::vector<std::thread> threads;
+                for (std::size_t i = 0; i < conns; ++i)
+                {
+                    received[i].store(0);
+                    threads.push_back(std::thread(echo_client, std::ref(clients[i]), size,
+                        opts.depth, std::cref(done), std::ref(received[i])));
+                }
+
+                sleep_ms(opts.warmup_ms);
+                uint64_t start_bytes = 0;
+                for (std::size_t i = 0; i < conns; ++i)
+                    start_bytes += received[i].load();
+                uint64_t start = now_ns();
+                sleep_ms(opts.duration_ms);
+                uint64_t end_bytes = 0;
+                for (std::size_t i = 0; i < conns; ++i)
+                    end_bytes += received[i].load();
+                double seconds = static_cast<double>(now_ns() - start) / 1e9;
+
+                done.store(true);
+                for (std::size_t i = 0; i < threads.size(); ++i)
+                    threads[i].join();
+                clients.clear();
+                server.reset();
+
+                double bytes = static_cast<double>(end_bytes - start_bytes);
+                std::printf("%-14s %6zu %6s %6zu %14.0f %12.1f\n", backend.c_str(), conns,
+                    format_size(size).c_str(), opts.depth, bytes / size / seconds,
+                    bytes / (1024.0 * 1024.0) / seconds);
+                std::fflush(stdout);
+            }
+        }
+    }
+    return 0;
+}
+
+int run_tcp_pingpong(const options& opts)
+{
+    std::vector<std::size_t> connections = opts.connections;
+    if (connections.empty())
+        connections = { 1, 4 };
+    std::vector<std::size_t> sizes = opts.sizes;
+    if (sizes.empty())
+        sizes = { 64, 1024, 16 * 1024 };
+
+    std::printf("%-14s %6s %6s %12s %9s %9s %9s %9s %9s %9s  (usec)\n", "backend", "conns", "size",
+        "rtt/s", "p50", "p90", "p99", "p99.9", "p99.99", "max");
+    for (const std::string& backend : available_backends())
+    {
+        if (!opts.wants_backend(backend))
+            continue;
+        for (std::size_t conns : connections)
+        {
+            for (std::size_t size : sizes)
+            {
+                std::unique_ptr<echo_server> server = start_server(backend, conns);
+                if (!server)
+                    break;
+                std::vector<tcp::socket> clients = connect_clients(server->endpoint(), conns);
+
+                std::atomic<bool> measuring(false);
+                std::atomic<bool> done(false);
+                std::vector<histogram> latencies(conns);
+                std::vector<std::thread> threads;
+                for (std::size_t i = 0; i < conns; ++i)
+                {
+                    threads.push_back(std::thread(pingpong_client, std::ref(clients[i]), size,
+                        std::cref(measuring), std::cref(done), std::ref(latencies[i])));
+                }
+
+                sleep_ms(opts.warmup_ms);
+                measuring.store(true);
+                uint64_t start = now_ns();
+                sleep_ms(opts.duration_ms);
+                measuring.store(false);
+                double seconds = static_cast<double>(now_ns() - start) / 1e9;
+
+                done.store(true);
+                for (std::size_t i = 0; i < threads.size(); ++i)
+                    threads[i].join();
+                clients.clear();
+                server.reset();
+
+                histogram latency;
+                for (std::size_t i = 0; i < latencies.size(); ++i)
+                    latency.merge(latencies[i]);
+                std::printf("%-14s %6zu %6s %12.0f %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+                    backend.c_str(), conns, format_size(size).c_str(),
+                    static_cast<double>(latency.count()) / seconds,
+                    latency.percentile(50) / 1e3, latency.percentile(90) / 1e3,
+                    latency.percentile(99) / 1e3, latency.percentile(99.9) / 1e3,
+                    latency.percentile(99.99) / 1e3, latency.max() / 1e3);
+                std::fflush(stdout);
+            }
+        }
+    }
+    return 0;
+}
+
+} // namespace bench
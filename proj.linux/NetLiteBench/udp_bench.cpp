@@ -0,0 +1,334 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#include <poll.h>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "NetLite/udp.hpp"
+#include "NetLite/mutablebuf.hpp"
+#if defined(NETWORK_HAS_IO_URING)
+# include "NetLite/buffer_pool.hpp"
+# include "NetLite/io_services/io_uring_io_context.hpp"
+#endif // defined(NETWORK_HAS_IO_URING)
+#include "bench.hpp"
+
+namespace bench{
+namespace{
+
+using NetLite::udp;
+
+// A datagram sink on an ephemeral loopback port that counts what arrives.
+class udp_receiver
+{
+public:
+    udp_receiver()
+        : received_(0)
+    {
+        socket_.open();
+        std::error_code ec;
+        socket_.set_option(NetLite::socket_base::receive_buffer_size(4 * 1024 * 1024), ec);
+        socket_.bind(udp::endpoint(NetLite::ip::address::from_string("127.0.0.1"), 0));
+        endpoint_ = socket_.local_endpoint();
+    }
+
+    virtual ~udp_receiver()
+    {
+    }
+
+    const udp::endpoint& endpoint() const
+    {
+        return endpoint_;
+    }
+
+    uint64_t received() const
+    {
+        return received_.load(std::memory_order_relaxed);
+    }
+
+protected:
+    udp::socket socket_;
+    udp::endpoint endpoint_;
+    std::atomic<uint64_t> received_;
+};
+
+// receive_from() on one thread. A batch of one is a blocking receive per
+// datagram; a larger batch waits for readiness and then drains up to that
+// many datagrams with non-blocking receives.
+class blocking_udp_receiver : public udp_receiver
+{
+public:
+    explicit blocking_udp_receiver(std::size_t batch)
+        : batch_(batch)
+        , stop_(false)
+    {
+        if (batch_ > 1)
+            socket_.non_blocking(true);
+        thread_ = std::thread(&blocking_udp_receiver::run, this);
+    }
+
+    ~blocking_udp_receiver()
+    {
+        stop_.store(true);
+        // Wake a receiver blocked in receive_from().
+        udp::socket waker;
+        waker.open();
+        char byte = 0;
+        NetLite::mutablebuf wake(&byte, 1);
+        std::error_code ec;
+        waker.send_to(wake, endpoint_, 0, ec);
+        thread_.join();
+    }
+
+private:
+    void run()
+    {
+        std::vector<char> storage(64 * 1024);
+        NetLite::mutablebuf buffer(storage.data(), storage.size());
+        udp::endpoint sender;
+        uint64_t count = 0;
+        std::error_code ec;
+        while (!stop_.load(std::memory_order_relaxed))
+        {
+            if (batch_ <= 1)
+            {
+                socket_.receive_from(buffer, sender, 0, ec);
+                if (!ec)
+                    received_.store(++count, std::memory_order_relaxed);
+                continue;
+            }
+
+            pollfd fd;
+            fd.fd = socket_.native_handle();
+            fd.events = POLLIN;
+            fd.revents = 0;
+            if (::poll(&fd, 1, 10) <= 0)
+                continue;
+            for (std::size_t i = 0; i < batch_; ++i)
+            {
+                socket_.receive_from(buffer, sender, 0, ec);
+                if (ec)
+                    break;
+                ++count;
+            }
+            received_.store(count, std::memory_order_relaxed);
+        }
+    }
+
+    std::size_t batch_;
+    std::atomic<bool> stop_;
+    std::thread thread_;
+};
+
+#if defined(NETWORK_HAS_IO_URING)
+
+// A multishot receive on an io_uring_io_context thread, with the buffers
+// either picked by the kernel from a group or borrowed from a pool.
+class io_uring_udp_receiver : public udp_receiver
+{
+public:
+    explicit io_uring_udp_receiver(bool pooled)
+        : io_(1024)
+        , count_(0)
+    {
+        if (pooled)
+        {
+            io_.async_receive(socket_, pool_, [this](const std::error_code& ec, NetLite::mutablebuf buffer)
+            {
+                if (!ec && buffer.size() != 0)
+                    received_.store(++count_, std::memory_order_relaxed);
+            });
+        }
+        else
+        {
+            unsigned short group = io_.add_buffer_group(1024, 2048);
+            io_.async_receive(socket_, group, [this](const std::error_code& ec, const char*, std::size_t size)
+            {
+                if (!ec && size != 0)
+                    received_.store(++count_, std::memory_order_relaxed);
+            });
+        }
+        thread_ = std::thread([this]()
+        {
+            std::error_code ec;
+            io_.run(ec);
+        });
+    }
+
+    ~io_uring_udp_receiver()
+    {
+        io_.stop();
+        thread_.join();
+    }
+
+private:
+    NetLite::buffer_pool pool_;
+    NetLite::io_uring_io_context io_;
+    uint64_t count_;
+    std::thread thread_;
+};
+
+#endif // defined(NETWORK_HAS_IO_URING)
+
+std::unique_ptr<udp_receiver> start_receiver(const std::string& backend, std::size_t batch)
+{
+    try
+    {
+        if (backend == "blocking")
+            return std::unique_ptr<udp_receiver>(new blocking_udp_receiver(batch));
+#if defined(NETWORK_HAS_IO_URING)
+        if (backend == "io_uring")
+            return std::unique_ptr<udp_receiver>(new io_uring_udp_receiver(false));
+        if (backend == "io_uring-pool")
+            return std::unique_ptr<udp_receiver>(new io_uring_udp_receiver(true));
+#endif // defined(NETWORK_HAS_IO_URING)
+    }
+    catch (const std::system_error& e)
+    {
+        std::printf("%-14s skipped: %s\n", backend.c_str(), e.what());
+    }
+    return std::unique_ptr<udp_receiver>();
+}
+
+// Send datagrams as fast as send_to() allows until told to stop, idling
+// while paused.
+void udp_sender(const udp::endpoint& destination, std::size_t size,
+    const std::atomic<bool>& paused, const std::atomic<bool>& done,
+    std::atomic<uint64_t>& sent)
+{
+    udp::socket socket;
+    socket.open();
+    std::vector<char> storage(size, 'x');
+    NetLite::mutablebuf buffer(storage.data(), storage.size());
+    uint64_t count = 0;
+    std::error_code ec;
+    while (!done.load(std::memory_order_relaxed))
+    {
+        if (paused.load(std::memory_order_relaxed))
+        {
+            sleep_ms(1);
+            continue;
+        }
+        socket.send_to(buffer, destination, 0, ec);
+        if (!ec)
+            sent.store(++count, std::memory_order_relaxed);
+    }
+}
+
+uint64_t total_sent(const std::vector<std::atomic<uint64_t> >& sent)
+{
+    uint64_t total = 0;
+    for (std::size_t i = 0; i < sent.size(); ++i)
+        total += sent[i].load();
+    return total;
+}
+
+// Wait for paused senders to go quiet and for the receiver to drain what is
+// still queued, so that every datagram counted as sent has been received or
+// dropped. Both counters are then read at the same point.
+void settle(const std::vector<std::atomic<uint64_t> >& sent, const udp_receiver& receiver,
+    uint64_t& sent_count, uint64_t& received_count)
+{
+    sent_count = total_sent(sent);
+    received_count = receiver.received();
+    for (;;)
+    {
+        sleep_ms(20);
+        uint64_t now_sent = total_sent(sent);
+        uint64_t now_received = receiver.received();
+        if (now_sent == sent_count && now_received == received_count)
+            return;
+        sent_count = now_sent;
+        received_count = now_received;
+    }
+}
+
+} // namespace
+
+int run_udp_pps(const options& opts)
+{
+    std::vector<std::size_t> senders = opts.connections;
+    if (senders.empty())
+        senders = { 1 };
+    std::vector<std::size_t> sizes = opts.sizes;
+    if (sizes.empty())
+        sizes = { 64, 512, 1472 };
+    std::vector<std::size_t> batches = opts.batches;
+    if (batches.empty())
+        batches = { 1, 8, 32 };
+
+    std::printf("%-14s %7s %6s %6s %12s %12s %7s\n", "backend", "senders", "size", "batch",
+        "sent/s", "recv/s", "loss%");
+    for (const std::string& backend : available_backends())
+    {
+        if (!opts.wants_backend(backend))
+            continue;
+        // Only the blocking receiver has a batch size; the io_uring ones are
+        // driven by the kernel.
+        std::vector<std::size_t> backend_batches = batches;
+        if (backend != "blocking")
+            backend_batches = { 0 };
+        for (std::size_t sender_count : senders)
+        {
+            for (std::size_t size : sizes)
+            {
+                for (std::size_t batch : backend_batches)
+                {
+                    std::unique_ptr<udp_receiver> receiver = start_receiver(backend, batch);
+                    if (!receiver)
+                        break;
+
+                    std::atomic<bool> paused(false);
+                    std::atomic<bool> done(false);
+                    std::vector<std::atomic<uint64_t> > sent(sender_count);
+                    std::vector<std::thread> threads;
+                    for (std::size_t i = 0; i < sender_count; ++i)
+                    {
+                        sent[i].store(0);
+                        threads.push_back(std::thread(udp_sender, std::cref(receiver->endpoint()),
+                            size, std::cref(paused), std::cref(done), std::ref(sent[i])));
+                    }
+
+                    // The window is bounded by pauses on both sides, so the
+                    // datagrams in flight at its edges are not counted as
+                    // received without having been counted as sent.
+                    sleep_ms(opts.warmup_ms);
+                    paused.store(true);
+                    uint64_t start_sent = 0;
+                    uint64_t start_received = 0;
+                    settle(sent, *receiver, start_sent, start_received);
+                    uint64_t start = now_ns();
+                    paused.store(false);
+                    sleep_ms(opts.duration_ms);
+                    paused.store(true);
+                    double seconds = static_cast<double>(now_ns() - start) / 1e9;
+                    uint64_t end_sent = 0;
+                    uint64_t end_received = 0;
+                    settle(sent, *receiver, end_sent, end_received);
+
+                    done.store(true);
+                    for (std::size_t i = 0; i < threads.size(); ++i)
+                        threads[i].join();
+                    receiver.reset();
+
+                    double sent_count = static_cast<double>(end_sent - start_sent);
+                    double received_count = static_cast<double>(end_received - start_received);
+                    double loss = sent_count > received_count ? 100.0 * (1.0 - received_count / sent_count) : 0.0;
+                    std::printf("%-14s %7zu %6s %6s %12.0f %12.0f %7.2f\n", backend.c_str(), sender_count,
+                        format_size(size).c_str(), batch ? std::to_string(batch).c_str() : "-",
+                        sent_count / seconds, received_count / seconds, loss);
+                    std::fflush(stdout);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,314 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#include <string>
+#include <system_error>
+#include "NetLite/tcp.hpp"
+#include "NetLite/socket_ops.hpp"
+#include "NetLite/ip/address.hpp"
+#include "NetLite/ip/address_v4.hpp"
+#include "NetLite/ip/address_v6.hpp"
+#include "NetLite/ip/endpoint.hpp"
+#include "NetLite/ip/compact_endpoint.hpp"
+#include "microbench.hpp"
+
+namespace{
+
+using NetLite::ip::address;
+using NetLite::ip::address_v4;
+using NetLite::ip::address_v6;
+
+const char v4_text[] = "192.168.100.200";
+const char v6_text[] = "2001:db8:85a3::8a2e:370:7334";
+const char v6_full_text[] = "2001:0db8:85a3:0000:0000:8a2e:0370:7334";
+
+// Parsing
+
+void bm_address_from_string_v4(microbench::state& state)
+{
+    const char* text = v4_text;
+    std::error_code ec;
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(text);
+        microbench::do_not_optimize(address::from_string(text, ec));
+    }
+}
+MICROBENCH(bm_address_from_string_v4);
+
+void bm_address_from_string_v6(microbench::state& state)
+{
+    const char* text = v6_text;
+    std::error_code ec;
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(text);
+        microbench::do_not_optimize(address::from_string(text, ec));
+    }
+}
+MICROBENCH(bm_address_from_string_v6);
+
+void bm_address_from_string_std_string(microbench::state& state)
+{
+    std::string text(v4_text);
+    std::error_code ec;
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(text);
+        microbench::do_not_optimize(address::from_string(text, ec));
+    }
+}
+MICROBENCH(bm_address_from_string_std_string);
+
+void bm_address_from_string_invalid(microbench::state& state)
+{
+    const char* text = "192.168.1.300";
+    std::error_code ec;
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(text);
+        microbench::do_not_optimize(address::from_string(text, ec));
+    }
+}
+MICROBENCH(bm_address_from_string_invalid);
+
+void bm_address_v4_from_string(microbench::state& state)
+{
+    const char* text = v4_text;
+    std::error_code ec;
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(text);
+        microbench::do_not_optimize(address_v4::from_string(text, ec));
+    }
+}
+MICROBENCH(bm_address_v4_from_string);
+
+void bm_address_v6_from_string(microbench::state& state)
+{
+    const char* text = v6_text;
+    std::error_code ec;
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(text);
+        microbench::do_not_optimize(address_v6::from_string(text, ec));
+    }
+}
+MICROBENCH(bm_address_v6_from_string);
+
+void bm_address_v6_from_string_full(microbench::state& state)
+{
+    const char* text = v6_full_text;
+    std::error_code ec;
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(text);
+        microbench::do_not_optimize(address_v6::from_string(text, ec));
+    }
+}
+MICROBENCH(bm_address_v6_from_string_full);
+
+// Formatting
+
+void bm_address_v4_to_string(microbench::state& state)
+{
+    address_v4 addr = address_v4::from_string(v4_text);
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(addr);
+        microbench::do_not_optimize(addr.to_string());
+    }
+}
+MICROBENCH(bm_address_v4_to_string);
+
+void bm_address_v6_to_string(microbench::state& state)
+{
+    address_v6 addr = address_v6::from_string(v6_text);
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(addr);
+        microbench::do_not_optimize(addr.to_string());
+    }
+}
+MICROBENCH(bm_address_v6_to_string);
+
+void bm_address_to_string(microbench::state& state)
+{
+    address addr = address::from_string(v4_text);
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(addr);
+        microbench::do_not_optimize(addr.to_string());
+    }
+}
+MICROBENCH(bm_address_to_string);
+
+void bm_address_v4_to_chars(microbench::state& state)
+{
+    address_v4 addr = address_v4::from_string(v4_text);
+    char buffer[64];
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(addr);
+        microbench::do_not_optimize(addr.to_chars(buffer, buffer + sizeof(buffer)));
+        microbench::clobber_memory();
+    }
+}
+MICROBENCH(bm_address_v4_to_chars);
+
+void bm_address_v6_to_chars(microbench::state& state)
+{
+    address_v6 addr = address_v6::from_string(v6_text);
+    char buffer[64];
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(addr);
+        microbench::do_not_optimize(addr.to_chars(buffer, buffer + sizeof(buffer)));
+        microbench::clobber_memory();
+    }
+}
+MICROBENCH(bm_address_v6_to_chars);
+
+// Endpoints
+
+void bm_ip_endpoint_from_address_v4(microbench::state& state)
+{
+    address addr = address::from_string(v4_text);
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(addr);
+        microbench::do_not_optimize(NetLite::ip::endpoint(addr, 8080));
+    }
+}
+MICROBENCH(bm_ip_endpoint_from_address_v4);
+
+void bm_ip_endpoint_from_address_v6(microbench::state& state)
+{
+    address addr = address::from_string(v6_text);
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(addr);
+        microbench::do_not_optimize(NetLite::ip::endpoint(addr, 8080));
+    }
+}
+MICROBENCH(bm_ip_endpoint_from_address_v6);
+
+void bm_tcp_endpoint_from_address(microbench::state& state)
+{
+    address addr = address::from_string(v4_text);
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(addr);
+        microbench::do_not_optimize(NetLite::tcp::endpoint(addr, 8080));
+    }
+}
+MICROBENCH(bm_tcp_endpoint_from_address);
+
+void bm_compact_endpoint_from_address(microbench::state& state)
+{
+    address addr = address::from_string(v4_text);
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(addr);
+        microbench::do_not_optimize(NetLite::ip::compact_endpoint(addr, 8080));
+    }
+}
+MICROBENCH(bm_compact_endpoint_from_address);
+
+void bm_endpoint_address(microbench::state& state)
+{
+    NetLite::tcp::endpoint ep(address::from_string(v6_text), 8080);
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(ep);
+        microbench::do_not_optimize(ep.address());
+    }
+}
+MICROBENCH(bm_endpoint_address);
+
+// Comparisons. The two endpoints differ only in the port, the last thing
+// compared.
+
+void bm_endpoint_equal_v4(microbench::state& state)
+{
+    NetLite::tcp::endpoint a(address::from_string(v4_text), 8080);
+    NetLite::tcp::endpoint b(address::from_string(v4_text), 8081);
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(a);
+        microbench::do_not_optimize(a == b);
+    }
+}
+MICROBENCH(bm_endpoint_equal_v4);
+
+void bm_endpoint_equal_v6(microbench::state& state)
+{
+    NetLite::tcp::endpoint a(address::from_string(v6_text), 8080);
+    NetLite::tcp::endpoint b(address::from_string(v6_text), 8081);
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(a);
+        microbench::do_not_optimize(a == b);
+    }
+}
+MICROBENCH(bm_endpoint_equal_v6);
+
+void bm_endpoint_less_v4(microbench::state& state)
+{
+    NetLite::tcp::endpoint a(address::from_string(v4_text), 8080);
+    NetLite::tcp::endpoint b(address::from_string(v4_text), 8081);
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(a);
+        microbench::do_not_optimize(a < b);
+    }
+}
+MICROBENCH(bm_endpoint_less_v4);
+
+void bm_endpoint_less_v6(microbench::state& state)
+{
+    NetLite::tcp::endpoint a(address::from_string(v6_text), 8080);
+    NetLite::tcp::endpoint b(address::from_string(v6_text), 8081);
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(a);
+        microbench::do_not_optimize(a < b);
+    }
+}
+MICROBENCH(bm_endpoint_less_v6);
+
+void bm_compact_endpoint_equal(microbench::state& state)
+{
+    NetLite::ip::compact_endpoint a(address::from_string(v6_text), 8080);
+    NetLite::ip::compact_endpoint b(address::from_string(v6_text), 8081);
+    while (state.keep_running())
+    {
+        microbench::do_not_optimize(a);
+        microbench::do_not_optimize(a == b);
+    }
+}
+MICROBENCH(bm_compact_endpoint_equal);
+
+// Byte order. The value changes every iteration so the conversion cannot be
+// folded away.
+
+void bm_host_to_network_short(microbench::state& state)
+{
+    NetLite::u_short_type value = 0;
+    while (state.keep_running())
+        microbench::do_not_optimize(NetLite::socket_ops::host_to_network_short(++value));
+}
+MICROBENCH(bm_host_to_network_short);
+
+void bm_host_to_network_long(microbench::state& state)
+{
+    NetLite::u_long_type value = 0;
+    while (state.keep_running())
+        microbench::do_not_optimize(NetLite::socket_ops::host_to_network_long(++value));
+}
+MICROBENCH(bm_host_to_network_long);
+
+} // namespace
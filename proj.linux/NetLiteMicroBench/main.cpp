@@ -0,0 +1,168 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include "microbench.hpp"
+
+namespace{
+
+// Not atomic: benchmarks run on the main thread only.
+uint64_t allocation_total = 0;
+
+uint64_t now_ns()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+struct entry
+{
+    const char* name;
+    microbench::function run;
+};
+
+std::vector<entry>& registry()
+{
+    static std::vector<entry> entries;
+    return entries;
+}
+
+void* counted_allocate(std::size_t size)
+{
+    ++allocation_total;
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    return counted_allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return counted_allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    ++allocation_total;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    ++allocation_total;
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace microbench{
+
+uint64_t allocation_count()
+{
+    return allocation_total;
+}
+
+void state::start()
+{
+    start_allocations_ = allocation_total;
+    start_ns_ = now_ns();
+}
+
+void state::stop()
+{
+    elapsed_ns_ = now_ns() - start_ns_;
+    allocations_ = allocation_total - start_allocations_;
+}
+
+registrar::registrar(const char* name, function f)
+{
+    entry e = { name, f };
+    registry().push_back(e);
+}
+
+} // namespace microbench
+
+int main(int argc, char* argv[])
+{
+    std::string filter;
+    double min_time_ms = 200;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+            min_time_ms = std::atof(argv[++i]);
+        else if (argv[i][0] != '-')
+            filter = argv[i];
+        else
+        {
+            std::fprintf(stderr, "usage: %s [filter] [--min-time <ms>]\n", argv[0]);
+            return 2;
+        }
+    }
+    const uint64_t min_time_ns = static_cast<uint64_t>(min_time_ms * 1e6);
+
+    std::printf("%-40s %12s %14s %10s\n", "Benchmark", "ns/op", "Iterations", "allocs/op");
+    for (const entry& e : registry())
+    {
+        if (!filter.empty() && std::strstr(e.name, filter.c_str()) == 0)
+            continue;
+
+        // Grow the iteration count until one run lasts at least the minimum
+        // time, the way Google Benchmark does.
+        uint64_t iterations = 1;
+        for (;;)
+        {
+            microbench::state s(iterations);
+            e.run(s);
+            if (s.elapsed_ns() >= min_time_ns || iterations >= 1000000000)
+            {
+                std::printf("%-40s %12.2f %14llu %10.2f\n", e.name,
+                    static_cast<double>(s.elapsed_ns()) / static_cast<double>(iterations),
+                    static_cast<unsigned long long>(iterations),
+                    static_cast<double>(s.allocations()) / static_cast<double>(iterations));
+                std::fflush(stdout);
+                break;
+            }
+            double multiplier = s.elapsed_ns() == 0 ? 10.0
+                : static_cast<double>(min_time_ns) * 1.4 / static_cast<double>(s.elapsed_ns());
+            if (multiplier > 10.0)
+                multiplier = 10.0;
+            uint64_t next = static_cast<uint64_t>(static_cast<double>(iterations) * multiplier);
+            iterations = next > iterations ? next : iterations + 1;
+        }
+    }
+    return 0;
+}
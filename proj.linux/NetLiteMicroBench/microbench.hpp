@@ -0,0 +1,113 @@
+/****************************************************************************
+  Copyright (c) 2018 libo All rights reserved.
+
+  losemymind.libo@gmail.com
+
+****************************************************************************/
+#ifndef NETLITE_MICROBENCH_HPP
+#define NETLITE_MICROBENCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace microbench{
+
+/// Heap allocations made by the process so far, counted by the replaced
+/// global operator new.
+uint64_t allocation_count();
+
+/**
+ * Passed to every benchmark function, which must run the code under test
+ * once per keep_running() that returns true:
+ * @code
+ * void bm_thing(microbench::state& state)
+ * {
+ *     while (state.keep_running())
+ *         microbench::do_not_optimize(thing());
+ * }
+ * MICROBENCH(bm_thing);
+ * @endcode
+ * Setup done before the loop is not measured.
+ */
+class state
+{
+public:
+    explicit state(uint64_t iterations)
+        : remaining_(iterations)
+        , started_(false)
+    {
+    }
+
+    bool keep_running()
+    {
+        if (!started_)
+        {
+            started_ = true;
+            start();
+        }
+        if (remaining_ != 0)
+        {
+            --remaining_;
+            return true;
+        }
+        stop();
+        return false;
+    }
+
+    uint64_t elapsed_ns() const
+    {
+        return elapsed_ns_;
+    }
+
+    uint64_t allocations() const
+    {
+        return allocations_;
+    }
+
+private:
+    void start();
+    void stop();
+
+    uint64_t remaining_;
+    bool started_;
+    uint64_t start_ns_;
+    uint64_t start_allocations_;
+    uint64_t elapsed_ns_;
+    uint64_t allocations_;
+};
+
+/// Keep the compiler from discarding a value that is computed but not used.
+template <typename T>
+inline void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// Make the compiler assume that a variable may have been changed, so that
+/// work depending on it cannot be hoisted out of the loop or folded into a
+/// constant.
+template <typename T>
+inline void do_not_optimize(T& value)
+{
+    asm volatile("" : "+r,m"(value) : : "memory");
+}
+
+/// Make the compiler assume that memory has been read and written.
+inline void clobber_memory()
+{
+    asm volatile("" : : : "memory");
+}
+
+typedef void (*function)(state&);
+
+/// Add a benchmark to the run; used through MICROBENCH.
+struct registrar
+{
+    registrar(const char* name, function f);
+};
+
+} // namespace microbench
+
+#define MICROBENCH(f) static ::microbench::registrar f##_registrar(#f, f)
+
+#endif // END OF NETLITE_MICROBENCH_HPP
@@ -22,12 +22,13 @@ int main()
         std::error_code ec;
         if (ServerSocket.has_pending_accept(ec))
         {
-            NetLite::tcp::endpoint RemoteEndpoint;
-            NetLite::tcp::socket ClientSocket = ServerSocket.accept(RemoteEndpoint);
-            ClientSocket.non_blocking(true);
-            Clients.insert(std::make_pair(ClientIndex++, ClientSocket));
-            std::cout << "Client connected:" << ClientSocket.native_handle() << " ipaddress:" << ClientSocket.remote_endpoint().address().to_string() << "port:" << ClientSocket.remote_endpoint().port() << std::endl;
-
+            std::vector<std::pair<NetLite::tcp::socket, NetLite::tcp::endpoint> > Accepted;
+            ServerSocket.accept_batch(Accepted, 64, ec);
+            for (auto& Peer : Accepted)
+            {
+                std::cout << "Client connected:" << Peer.first.native_handle() << " ipaddress:" << Peer.second.address() << "port:" << Peer.second.port() << std::endl;
+                Clients.insert(std::make_pair(ClientIndex++, std::move(Peer.first)));
+            }
         }
 
         for (auto& client : Clients)
@@ -37,7 +38,7 @@ int main()
                 std::vector<char> Buffer;
                 Buffer.resize(1024);
                 client.second.receive(NetLite::make_mutablebuf(Buffer));
-                std::cout << client.second.remote_endpoint().address().to_string()<<":"<<Buffer.data() << "\n" << std::endl;
+                std::cout << client.second.remote_endpoint().address() <<":"<<Buffer.data() << "\n" << std::endl;
                 char cid[2] = { 0 };
                 cid[0] = Buffer[0];
                 int clientid = atoi(cid);